@@ -390,6 +390,9 @@ void* sdl_thread(void* args) {
         return NULL;
     }
 
+    // Pace presents by the panel refresh, fall back to a fixed delay if the panel has no refresh timing
+    bool vsync = SDL_SetRenderVSync(renderer, 1);
+
     // Initialize simulation
     init_water_levels(SCREEN_WIDTH);
     init_duck();
@@ -450,7 +453,9 @@ void* sdl_thread(void* args) {
         
         // Yield to other tasks every frame to prevent watchdog timeout
         taskYIELD();
-        vTaskDelay(pdMS_TO_TICKS(16)); // ~60 FPS
+        if (!vsync) {
+            vTaskDelay(pdMS_TO_TICKS(16)); // ~60 FPS
+        }
     }
 
     SDL_DestroyRenderer(renderer);
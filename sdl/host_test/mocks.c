@@ -0,0 +1,791 @@
+#include "SDL_internal.h"
+#include "video/SDL_sysvideo.h"
+#include "events/SDL_events_c.h"
+#include "SDL3/SDL_video.h"
+#include "esp_heap_caps.h"
+#include "esp_lcd_panel_io.h"
+#include "esp_lcd_panel_ops.h"
+#include "esp_memory_utils.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "driver/gpio.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "mocks.h"
+#include <time.h>
+
+#define MOCK_MAX_HINTS 16
+#define MOCK_MAX_TRANSFERS 4096
+
+int mock_failures = 0;
+
+static char error[256];
+
+static struct
+{
+    const char *name;
+    const char *value;
+} hints[MOCK_MAX_HINTS];
+
+static struct
+{
+    const char *name;
+    SDL_HintCallback callback;
+    void *userdata;
+} hint_callbacks[MOCK_MAX_HINTS];
+
+static struct
+{
+    SDL_DisplayData *display;
+    SDL_VideoDisplay video_display;
+    int w, h, bytes_per_pixel;
+    uint8_t *ram;
+    esp_lcd_panel_io_color_trans_done_cb_t on_color_trans_done;
+    void *user_ctx;
+    mock_transfer log[MOCK_MAX_TRANSFERS];
+    int count;
+    int completed;  // Transfers before this one in the log have been completed
+    int max_in_flight;
+} panel;
+
+static int64_t now_us = 0;
+
+// Virtual time of the mock panel: the host time the driver runs plus the time it waits for the panel bus
+static struct
+{
+    int64_t now_ns;
+    int64_t host_ns;           // Host time when the driver last got control back from a mock
+    int64_t bytes_per_second;  // Panel bus speed, 0 for transfers that take no time
+    int64_t bus_free_ns;       // The panel bus is done with every transfer submitted so far
+} mock_clock;
+
+static int64_t mock_host_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// The driver ran since it last left a mock, that time counts
+static void mock_clock_enter(void)
+{
+    mock_clock.now_ns += mock_host_ns() - mock_clock.host_ns;
+}
+
+// The bookkeeping of the mocks themselves does not
+static void mock_clock_leave(void)
+{
+    mock_clock.host_ns = mock_host_ns();
+}
+
+/* SDL */
+
+bool SDL_SetError(const char *fmt, ...)
+{
+    va_list ap;
+
+    va_start(ap, fmt);
+    vsnprintf(error, sizeof(error), fmt, ap);
+    va_end(ap);
+    return false;
+}
+
+const char *SDL_GetError(void)
+{
+    return error;
+}
+
+bool SDL_RectEmpty(const SDL_Rect *r)
+{
+    return !r || r->w <= 0 || r->h <= 0;
+}
+
+bool SDL_RectsEqual(const SDL_Rect *a, const SDL_Rect *b)
+{
+    return a && b && a->x == b->x && a->y == b->y && a->w == b->w && a->h == b->h;
+}
+
+bool SDL_GetRectIntersection(const SDL_Rect *a, const SDL_Rect *b, SDL_Rect *result)
+{
+    int x1 = SDL_max(a->x, b->x);
+    int y1 = SDL_max(a->y, b->y);
+    int x2 = SDL_min(a->x + a->w, b->x + b->w);
+    int y2 = SDL_min(a->y + a->h, b->y + b->h);
+
+    *result = (SDL_Rect){ x1, y1, SDL_max(x2 - x1, 0), SDL_max(y2 - y1, 0) };
+    return !SDL_RectEmpty(result);
+}
+
+bool SDL_HasRectIntersection(const SDL_Rect *a, const SDL_Rect *b)
+{
+    SDL_Rect r;
+
+    return SDL_GetRectIntersection(a, b, &r);
+}
+
+void SDL_GetRectUnion(const SDL_Rect *a, const SDL_Rect *b, SDL_Rect *result)
+{
+    int x1 = SDL_min(a->x, b->x);
+    int y1 = SDL_min(a->y, b->y);
+    int x2 = SDL_max(a->x + a->w, b->x + b->w);
+    int y2 = SDL_max(a->y + a->h, b->y + b->h);
+
+    *result = (SDL_Rect){ x1, y1, x2 - x1, y2 - y1 };
+}
+
+SDL_Surface *SDL_CreateSurfaceFrom(int w, int h, SDL_PixelFormat format, void *pixels, int pitch)
+{
+    SDL_Surface *surface = calloc(1, sizeof(*surface));
+
+    if (surface) {
+        surface->format = format;
+        surface->w = w;
+        surface->h = h;
+        surface->pitch = pitch;
+        surface->pixels = pixels;
+        surface->refcount = 1;
+    }
+    return surface;
+}
+
+void SDL_DestroySurface(SDL_Surface *surface)
+{
+    free(surface);
+}
+
+SDL_Palette *SDL_GetSurfacePalette(SDL_Surface *surface)
+{
+    return NULL;
+}
+
+const char *SDL_GetPixelFormatName(SDL_PixelFormat format)
+{
+    switch (format) {
+    case SDL_PIXELFORMAT_INDEX4MSB:
+        return "SDL_PIXELFORMAT_INDEX4MSB";
+    case SDL_PIXELFORMAT_INDEX8:
+        return "SDL_PIXELFORMAT_INDEX8";
+    case SDL_PIXELFORMAT_RGB332:
+        return "SDL_PIXELFORMAT_RGB332";
+    case SDL_PIXELFORMAT_RGB565:
+        return "SDL_PIXELFORMAT_RGB565";
+    case SDL_PIXELFORMAT_RGB24:
+        return "SDL_PIXELFORMAT_RGB24";
+    case SDL_PIXELFORMAT_BGR24:
+        return "SDL_PIXELFORMAT_BGR24";
+    case SDL_PIXELFORMAT_XRGB8888:
+        return "SDL_PIXELFORMAT_XRGB8888";
+    case SDL_PIXELFORMAT_ARGB8888:
+        return "SDL_PIXELFORMAT_ARGB8888";
+    default:
+        return "SDL_PIXELFORMAT_UNKNOWN";
+    }
+}
+
+static void mock_store_hint(const char *name, const char *value)
+{
+    int free_slot = -1;
+
+    for (int i = 0; i < MOCK_MAX_HINTS; i++) {
+        if (hints[i].name && strcmp(hints[i].name, name) == 0) {
+            hints[i].value = value;
+            return;
+        }
+        if (!hints[i].name && free_slot < 0) {
+            free_slot = i;
+        }
+    }
+    MOCK_EXPECT(free_slot >= 0, "room for hint %s", name);
+    if (free_slot >= 0) {
+        hints[free_slot].name = name;
+        hints[free_slot].value = value;
+    }
+}
+
+void mock_set_hint(const char *name, const char *value)
+{
+    const char *old_value = SDL_GetHint(name);
+
+    mock_store_hint(name, value);
+    for (int i = 0; i < MOCK_MAX_HINTS; i++) {
+        if (hint_callbacks[i].callback && strcmp(hint_callbacks[i].name, name) == 0) {
+            hint_callbacks[i].callback(hint_callbacks[i].userdata, name, old_value, value);
+        }
+    }
+}
+
+// Like SDL, a callback added again replaces itself and gets the current value right away
+bool SDL_AddHintCallback(const char *name, SDL_HintCallback callback, void *userdata)
+{
+    int free_slot = -1;
+
+    SDL_RemoveHintCallback(name, callback, userdata);
+    for (int i = 0; i < MOCK_MAX_HINTS && free_slot < 0; i++) {
+        if (!hint_callbacks[i].callback) {
+            free_slot = i;
+        }
+    }
+    MOCK_EXPECT(free_slot >= 0, "room for a callback of hint %s", name);
+    if (free_slot < 0) {
+        return false;
+    }
+    hint_callbacks[free_slot].name = name;
+    hint_callbacks[free_slot].callback = callback;
+    hint_callbacks[free_slot].userdata = userdata;
+    callback(userdata, name, SDL_GetHint(name), SDL_GetHint(name));
+    return true;
+}
+
+void SDL_RemoveHintCallback(const char *name, SDL_HintCallback callback, void *userdata)
+{
+    for (int i = 0; i < MOCK_MAX_HINTS; i++) {
+        if (hint_callbacks[i].callback == callback && hint_callbacks[i].userdata == userdata &&
+            strcmp(hint_callbacks[i].name, name) == 0) {
+            hint_callbacks[i].callback = NULL;
+        }
+    }
+}
+
+const char *SDL_GetHint(const char *name)
+{
+    for (int i = 0; i < MOCK_MAX_HINTS; i++) {
+        if (hints[i].name && strcmp(hints[i].name, name) == 0) {
+            return hints[i].value;
+        }
+    }
+    return NULL;
+}
+
+bool SDL_GetHintBoolean(const char *name, bool default_value)
+{
+    const char *value = SDL_GetHint(name);
+
+    if (!value || !*value) {
+        return default_value;
+    }
+    return strcmp(value, "0") != 0 && strcasecmp(value, "false") != 0;
+}
+
+bool SDL_SetNumberProperty(SDL_PropertiesID props, const char *name, Sint64 value)
+{
+    return true;
+}
+
+Sint64 SDL_GetNumberProperty(SDL_PropertiesID props, const char *name, Sint64 default_value)
+{
+    return default_value;
+}
+
+Uint32 SDL_murmur3_32(const void *data, size_t len, Uint32 seed)
+{
+    // Any hash that sees every byte does for the tile diff, FNV-1a is shorter than murmur3
+    const uint8_t *bytes = data;
+    Uint32 hash = seed ^ 2166136261u;
+
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+SDL_VideoDevice *SDL_GetVideoDevice(void)
+{
+    return NULL;
+}
+
+SDL_VideoDisplay *SDL_GetVideoDisplayForWindow(SDL_Window *window)
+{
+    return panel.display ? &panel.video_display : NULL;
+}
+
+SDL_DisplayID SDL_GetDisplayForWindow(SDL_Window *window)
+{
+    return panel.display ? panel.video_display.id : 0;
+}
+
+bool SDL_GetDisplayBounds(SDL_DisplayID displayID, SDL_Rect *rect)
+{
+    if (!panel.display || displayID != panel.video_display.id) {
+        return SDL_SetError("Invalid display");
+    }
+    *rect = (SDL_Rect){ 0, 0, panel.w, panel.h };
+    return true;
+}
+
+void SDL_SetDesktopDisplayMode(SDL_VideoDisplay *display, const SDL_DisplayMode *mode)
+{
+    display->desktop_mode = *mode;
+}
+
+void SDL_SetCurrentDisplayMode(SDL_VideoDisplay *display, const SDL_DisplayMode *mode)
+{
+    display->current_mode = *mode;
+}
+
+SDL_PropertiesID SDL_GetWindowProperties(SDL_Window *window)
+{
+    return 1;
+}
+
+bool SDL_GetWindowSizeInPixels(SDL_Window *window, int *w, int *h)
+{
+    *w = window->w;
+    *h = window->h;
+    return true;
+}
+
+void SDL_CheckWindowPixelSizeChanged(SDL_Window *window)
+{
+}
+
+static struct
+{
+    int w, h;
+    SDL_RendererLogicalPresentation mode;
+} logical_presentation;
+
+void mock_set_logical_presentation(int w, int h, SDL_RendererLogicalPresentation mode)
+{
+    logical_presentation.w = w;
+    logical_presentation.h = h;
+    logical_presentation.mode = mode;
+}
+
+// Windows only have a renderer while a logical presentation is set, it is never dereferenced
+SDL_Renderer *SDL_GetRenderer(SDL_Window *window)
+{
+    return (logical_presentation.mode != SDL_LOGICAL_PRESENTATION_DISABLED) ? (SDL_Renderer *)&logical_presentation : NULL;
+}
+
+bool SDL_GetRenderLogicalPresentation(SDL_Renderer *renderer, int *w, int *h, SDL_RendererLogicalPresentation *mode)
+{
+    if (!renderer) {
+        return SDL_SetError("No renderer");
+    }
+    *w = logical_presentation.w;
+    *h = logical_presentation.h;
+    *mode = logical_presentation.mode;
+    return true;
+}
+
+bool SDL_SendWindowEvent(SDL_Window *window, int windowevent, int data1, int data2)
+{
+    return true;
+}
+
+/* Driver functions outside the modules under test */
+
+SDL_DisplayData *ESPIDF_GetPrimaryPanel(void)
+{
+    return (panel.display && panel.display->primary) ? panel.display : NULL;
+}
+
+/* ESP-IDF */
+
+void mock_check_failed(esp_err_t err, const char *expr, const char *file, int line)
+{
+    printf("%s:%d: %s returned %s\n", file, line, expr, esp_err_to_name(err));
+    mock_failures++;
+}
+
+const char *esp_err_to_name(esp_err_t err)
+{
+    static char name[16];
+
+    snprintf(name, sizeof(name), "0x%x", (unsigned)err);
+    return name;
+}
+
+void *heap_caps_aligned_alloc(size_t alignment, size_t size, uint32_t caps)
+{
+    void *ptr = NULL;
+
+    if (posix_memalign(&ptr, SDL_max(alignment, sizeof(void *)), size ? size : 1) != 0) {
+        return NULL;
+    }
+    return ptr;
+}
+
+void *heap_caps_aligned_calloc(size_t alignment, size_t n, size_t size, uint32_t caps)
+{
+    void *ptr = heap_caps_aligned_alloc(alignment, n * size, caps);
+
+    if (ptr) {
+        memset(ptr, 0, n * size);
+    }
+    return ptr;
+}
+
+void *heap_caps_malloc(size_t size, uint32_t caps)
+{
+    return malloc(size);
+}
+
+void *heap_caps_calloc(size_t n, size_t size, uint32_t caps)
+{
+    return calloc(n, size);
+}
+
+void heap_caps_free(void *ptr)
+{
+    free(ptr);
+}
+
+size_t heap_caps_get_free_size(uint32_t caps)
+{
+    return 256 * 1024;
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps)
+{
+    return 128 * 1024;
+}
+
+bool esp_ptr_dma_capable(const void *p)
+{
+    return true;
+}
+
+bool esp_ptr_external_ram(const void *p)
+{
+    return false;
+}
+
+int64_t esp_timer_get_time(void)
+{
+    return ++now_us;
+}
+
+// Timers are created and started but never fire, presents run unpaced
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out_handle)
+{
+    *out_handle = (esp_timer_handle_t)args;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+    return ESP_OK;
+}
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle)
+{
+    // As if the app never called nvs_flash_init()
+    return ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t nvs_get_u16(nvs_handle_t handle, const char *key, uint16_t *out_value)
+{
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t nvs_set_u16(nvs_handle_t handle, const char *key, uint16_t value)
+{
+    return ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    return ESP_ERR_INVALID_STATE;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+}
+
+esp_err_t gpio_config(const gpio_config_t *config)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t gpio_install_isr_service(int intr_alloc_flags)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, void (*isr_handler)(void *), void *args)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t gpio_isr_handler_remove(gpio_num_t gpio_num)
+{
+    return ESP_OK;
+}
+
+/* Mock panel */
+
+void mock_panel_init(SDL_DisplayData *display, int w, int h, int bytes_per_pixel)
+{
+    mock_panel_quit();
+    panel.display = display;
+    panel.video_display.id = 1;
+    panel.video_display.desktop_mode.format = SDL_PIXELFORMAT_RGB565;
+    panel.video_display.desktop_mode.w = w;
+    panel.video_display.desktop_mode.h = h;
+    panel.video_display.current_mode = panel.video_display.desktop_mode;
+    panel.video_display.internal = display;
+    panel.w = w;
+    panel.h = h;
+    panel.bytes_per_pixel = bytes_per_pixel;
+    panel.ram = calloc((size_t)w * h, bytes_per_pixel);
+    mock_clock_leave();
+}
+
+void mock_panel_set_bus_speed(int64_t bytes_per_second)
+{
+    mock_clock.bytes_per_second = bytes_per_second;
+}
+
+int64_t mock_clock_ns(void)
+{
+    mock_clock_enter();
+    mock_clock_leave();
+    return mock_clock.now_ns;
+}
+
+void mock_panel_reset_log(void)
+{
+    MOCK_EXPECT(mock_panel_in_flight() == 0, "no transfers in flight when the log is reset, %d are", mock_panel_in_flight());
+    for (int i = 0; i < panel.count; i++) {
+        free(panel.log[i].snapshot);
+    }
+    panel.count = 0;
+    panel.completed = 0;
+    panel.max_in_flight = 0;
+}
+
+void mock_panel_quit(void)
+{
+    mock_panel_reset_log();
+    free(panel.ram);
+    memset(&panel, 0, sizeof(panel));
+}
+
+const uint8_t *mock_panel_ram(void)
+{
+    return panel.ram;
+}
+
+int mock_panel_transfer_count(void)
+{
+    return panel.count;
+}
+
+const mock_transfer *mock_panel_transfer(int i)
+{
+    return &panel.log[i];
+}
+
+int mock_panel_in_flight(void)
+{
+    return panel.count - panel.completed;
+}
+
+int mock_panel_max_in_flight(void)
+{
+    return panel.max_in_flight;
+}
+
+// The panel finishes its oldest transfer: the data lands in panel RAM and the done callback runs as from the ISR
+static bool mock_panel_complete_oldest(void)
+{
+    if (mock_panel_in_flight() == 0) {
+        return false;
+    }
+
+    mock_transfer *t = &panel.log[panel.completed++];
+    // Waiting for the panel lets the bus time pass
+    mock_clock.now_ns = SDL_max(mock_clock.now_ns, t->done_ns);
+    MOCK_EXPECT(memcmp(t->data, t->snapshot, t->size) == 0, "transfer %d at (%d,%d) %dx%d unchanged until the panel read it",
+                panel.completed - 1, t->rect.x, t->rect.y, t->rect.w, t->rect.h);
+
+    size_t row_bytes = (size_t)t->rect.w * panel.bytes_per_pixel;
+    for (int y = 0; y < t->rect.h; y++) {
+        memcpy(panel.ram + ((size_t)(t->rect.y + y) * panel.w + t->rect.x) * panel.bytes_per_pixel,
+               t->snapshot + y * row_bytes, row_bytes);
+    }
+
+    if (panel.on_color_trans_done) {
+        panel.on_color_trans_done(NULL, &(esp_lcd_panel_io_event_data_t){ 0 }, panel.user_ctx);
+    }
+    return true;
+}
+
+esp_err_t esp_lcd_panel_io_register_event_callbacks(esp_lcd_panel_io_handle_t io, const esp_lcd_panel_io_callbacks_t *cbs, void *user_ctx)
+{
+    panel.on_color_trans_done = cbs->on_color_trans_done;
+    panel.user_ctx = user_ctx;
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_io_tx_param(esp_lcd_panel_io_handle_t io, int lcd_cmd, const void *param, size_t param_size)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_draw_bitmap(esp_lcd_panel_handle_t handle, int x_start, int y_start, int x_end, int y_end, const void *color_data)
+{
+    SDL_Rect rect = { x_start, y_start, x_end - x_start, y_end - y_start };
+
+    mock_clock_enter();
+    if (rect.w <= 0 || rect.h <= 0 || x_start < 0 || y_start < 0 || x_end > panel.w || y_end > panel.h) {
+        MOCK_EXPECT(false, "transfer (%d,%d)-(%d,%d) inside the %dx%d panel", x_start, y_start, x_end, y_end, panel.w, panel.h);
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (panel.count == MOCK_MAX_TRANSFERS) {
+        MOCK_EXPECT(false, "at most %d transfers between log resets", MOCK_MAX_TRANSFERS);
+        return ESP_ERR_NO_MEM;
+    }
+
+    // A buffer may only be handed over again once the panel is done reading it
+    for (int i = panel.completed; i < panel.count; i++) {
+        MOCK_EXPECT(panel.log[i].data != color_data, "buffer %p of transfer %d not reused by transfer %d while in flight",
+                    color_data, i, panel.count);
+    }
+
+    mock_transfer *t = &panel.log[panel.count++];
+    t->rect = rect;
+    t->data = color_data;
+    t->size = (size_t)rect.w * rect.h * panel.bytes_per_pixel;
+    t->snapshot = malloc(t->size);
+    memcpy(t->snapshot, color_data, t->size);
+    panel.max_in_flight = SDL_max(panel.max_in_flight, mock_panel_in_flight());
+
+    // The bus sends one transfer after the other, each as soon as it is queued and the bus is free
+    int64_t start_ns = SDL_max(mock_clock.now_ns, mock_clock.bus_free_ns);
+    t->done_ns = start_ns + (mock_clock.bytes_per_second ? (int64_t)t->size * 1000000000 / mock_clock.bytes_per_second : 0);
+    mock_clock.bus_free_ns = t->done_ns;
+    mock_clock_leave();
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_swap_xy(esp_lcd_panel_handle_t handle, bool swap_axes)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_mirror(esp_lcd_panel_handle_t handle, bool mirror_x, bool mirror_y)
+{
+    return ESP_OK;
+}
+
+/* FreeRTOS */
+
+struct mock_semaphore
+{
+    UBaseType_t count;
+    UBaseType_t max_count;
+};
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count)
+{
+    SemaphoreHandle_t sem = calloc(1, sizeof(*sem));
+
+    if (sem) {
+        sem->count = initial_count;
+        sem->max_count = max_count;
+    }
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return xSemaphoreCreateCounting(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return xSemaphoreCreateCounting(1, 1);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    if (sem->count == sem->max_count) {
+        return pdFALSE;
+    }
+    sem->count++;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t *higher_priority_task_woken)
+{
+    return xSemaphoreGive(sem);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks_to_wait)
+{
+    BaseType_t taken = pdTRUE;
+
+    mock_clock_enter();
+    // There is no other task, so while the caller waits only the panel makes progress
+    while (sem->count == 0) {
+        if (ticks_to_wait == 0 || !mock_panel_complete_oldest()) {
+            MOCK_EXPECT(ticks_to_wait != portMAX_DELAY, "something to wait for on a semaphore taken without timeout");
+            taken = pdFALSE;
+            break;
+        }
+    }
+    if (taken) {
+        sem->count--;
+    }
+    mock_clock_leave();
+    return taken;
+}
+
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t sem)
+{
+    return sem->count;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem)
+{
+    free(sem);
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char *name, uint32_t stack_depth, void *arg,
+                                   UBaseType_t priority, TaskHandle_t *created_task, BaseType_t core_id)
+{
+    return pdFALSE;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    mock_clock_enter();
+    mock_panel_complete_oldest();
+    mock_clock_leave();
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_count_on_exit, TickType_t ticks_to_wait)
+{
+    return 0;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    return pdTRUE;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higher_priority_task_woken)
+{
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(now_us / 1000);
+}
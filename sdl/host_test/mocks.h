@@ -0,0 +1,61 @@
+/*
+ * Host mocks of the SDL, ESP-IDF and FreeRTOS calls the esp-idf video driver
+ * makes. The mock panel keeps transfers in flight until the driver blocks on
+ * a semaphore, then completes the oldest one like the panel ISR would, so the
+ * chunk ring runs as full as it can on the device. With a bus speed set, the
+ * wait also advances a virtual clock to the end of that transfer, so the time
+ * a flush takes shows how well conversion and transfers overlap.
+ */
+#ifndef MOCKS_H_
+#define MOCKS_H_
+
+#include "SDL_internal.h"
+#include "SDL_espidfshared.h"
+
+// One esp_lcd_panel_draw_bitmap call, in the order the driver made them
+typedef struct mock_transfer
+{
+    SDL_Rect rect;     // Panel area
+    const void *data;  // Buffer the driver handed over
+    size_t size;
+    uint8_t *snapshot;  // Buffer content at submission, to catch reuse while in flight
+    int64_t done_ns;    // Virtual time the panel finishes reading it
+} mock_transfer;
+
+// Panel of w x h pixels behind the display, with bytes_per_pixel of RAM per pixel
+extern void mock_panel_init(SDL_DisplayData *display, int w, int h, int bytes_per_pixel);
+extern void mock_panel_quit(void);
+// Panel RAM the completed transfers were written into, row after row
+extern const uint8_t *mock_panel_ram(void);
+// Transfers submitted since the last reset, in order, and how many are still in flight
+extern int mock_panel_transfer_count(void);
+extern const mock_transfer *mock_panel_transfer(int i);
+extern int mock_panel_in_flight(void);
+extern int mock_panel_max_in_flight(void);
+extern void mock_panel_reset_log(void);
+
+// Transfers take their size over this many bytes per second on a bus that sends one at a time, 0 makes them
+// instant. The driver waits for them on the virtual clock, which otherwise follows the host time the driver runs.
+extern void mock_panel_set_bus_speed(int64_t bytes_per_second);
+extern int64_t mock_clock_ns(void);
+
+// Logical presentation of the renderer every window has, DISABLED for no renderer at all
+extern void mock_set_logical_presentation(int w, int h, SDL_RendererLogicalPresentation mode);
+
+// Value SDL_GetHint returns for name, NULL to unset it, hint callbacks of name see the change
+extern void mock_set_hint(const char *name, const char *value);
+
+// Failed expectations so far, tests exit with an error when there are any
+extern int mock_failures;
+
+#define MOCK_EXPECT(cond, ...)                                    \
+    do {                                                          \
+        if (!(cond)) {                                            \
+            printf("%s:%d: expected %s: ", __FILE__, __LINE__, #cond); \
+            printf(__VA_ARGS__);                                  \
+            printf("\n");                                         \
+            mock_failures++;                                      \
+        }                                                         \
+    } while (0)
+
+#endif /* MOCKS_H_ */
@@ -0,0 +1,4 @@
+/* Stand-in for the public SDL header, see SDL_internal.h */
+#pragma once
+
+#include "SDL_internal.h"
@@ -0,0 +1,6 @@
+/* Stand-in for the public SDL header, see SDL_internal.h */
+#pragma once
+
+#include "SDL_internal.h"
+
+extern bool SDL_GetDisplayBounds(SDL_DisplayID displayID, SDL_Rect *rect);
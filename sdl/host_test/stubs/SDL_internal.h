@@ -0,0 +1,179 @@
+/*
+ * Stand-in for SDL's internal header: the SDL types, macros and functions the
+ * esp-idf video driver uses, implemented by mocks.c on top of the C library.
+ */
+#pragma once
+
+#include "sdkconfig.h"
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#define SDL_VIDEO_DRIVER_PRIVATE 1
+
+#define SDLCALL
+#define SDL_DECLSPEC
+
+typedef uint8_t Uint8;
+typedef uint16_t Uint16;
+typedef uint32_t Uint32;
+typedef uint64_t Uint64;
+typedef int32_t Sint32;
+typedef int64_t Sint64;
+typedef Uint32 SDL_PropertiesID;
+typedef Uint32 SDL_DisplayID;
+typedef Uint32 SDL_WindowID;
+
+#define SDL_PRIu64 "llu"
+#define SDL_PRIs64 "lld"
+
+typedef enum SDL_PixelFormat
+{
+    SDL_PIXELFORMAT_UNKNOWN,
+    SDL_PIXELFORMAT_INDEX4MSB,
+    SDL_PIXELFORMAT_INDEX8,
+    SDL_PIXELFORMAT_RGB332,
+    SDL_PIXELFORMAT_RGB565,
+    SDL_PIXELFORMAT_RGB24,
+    SDL_PIXELFORMAT_BGR24,
+    SDL_PIXELFORMAT_XRGB8888,
+    SDL_PIXELFORMAT_ARGB8888,
+} SDL_PixelFormat;
+
+static inline int SDL_BITSPERPIXEL(SDL_PixelFormat format)
+{
+    switch (format) {
+    case SDL_PIXELFORMAT_INDEX4MSB:
+        return 4;
+    case SDL_PIXELFORMAT_INDEX8:
+    case SDL_PIXELFORMAT_RGB332:
+        return 8;
+    case SDL_PIXELFORMAT_RGB565:
+        return 16;
+    case SDL_PIXELFORMAT_RGB24:
+    case SDL_PIXELFORMAT_BGR24:
+        return 24;
+    case SDL_PIXELFORMAT_XRGB8888:
+    case SDL_PIXELFORMAT_ARGB8888:
+        return 32;
+    default:
+        return 0;
+    }
+}
+
+#define SDL_BYTESPERPIXEL(format) ((SDL_BITSPERPIXEL(format) + 7) / 8)
+#define SDL_ISPIXELFORMAT_INDEXED(format) ((format) == SDL_PIXELFORMAT_INDEX4MSB || (format) == SDL_PIXELFORMAT_INDEX8)
+
+typedef enum SDL_DisplayOrientation
+{
+    SDL_ORIENTATION_UNKNOWN,
+    SDL_ORIENTATION_LANDSCAPE,
+    SDL_ORIENTATION_LANDSCAPE_FLIPPED,
+    SDL_ORIENTATION_PORTRAIT,
+    SDL_ORIENTATION_PORTRAIT_FLIPPED,
+} SDL_DisplayOrientation;
+
+typedef enum SDL_RendererLogicalPresentation
+{
+    SDL_LOGICAL_PRESENTATION_DISABLED,
+    SDL_LOGICAL_PRESENTATION_STRETCH,
+    SDL_LOGICAL_PRESENTATION_LETTERBOX,
+    SDL_LOGICAL_PRESENTATION_OVERSCAN,
+    SDL_LOGICAL_PRESENTATION_INTEGER_SCALE,
+} SDL_RendererLogicalPresentation;
+
+typedef struct SDL_Rect
+{
+    int x, y, w, h;
+} SDL_Rect;
+
+typedef struct SDL_Color
+{
+    Uint8 r, g, b, a;
+} SDL_Color;
+
+typedef struct SDL_Palette
+{
+    int ncolors;
+    SDL_Color *colors;
+    Uint32 version;
+    int refcount;
+} SDL_Palette;
+
+typedef struct SDL_Surface
+{
+    Uint32 flags;
+    SDL_PixelFormat format;
+    int w, h;
+    int pitch;
+    void *pixels;
+    int refcount;
+    void *reserved;
+} SDL_Surface;
+
+typedef struct SDL_DisplayMode
+{
+    SDL_DisplayID displayID;
+    SDL_PixelFormat format;
+    int w, h;
+    float pixel_density;
+    float refresh_rate;
+    void *internal;
+} SDL_DisplayMode;
+
+typedef struct SDL_Window SDL_Window;
+typedef struct SDL_Renderer SDL_Renderer;
+
+#define SDL_min(x, y) (((x) < (y)) ? (x) : (y))
+#define SDL_max(x, y) (((x) > (y)) ? (x) : (y))
+#define SDL_clamp(x, a, b) (((x) < (a)) ? (a) : (((x) > (b)) ? (b) : (x)))
+#define SDL_abs(x) (((x) < 0) ? -(x) : (x))
+#define SDL_arraysize(array) (sizeof(array) / sizeof(array[0]))
+#define SDL_zero(x) memset(&(x), 0, sizeof(x))
+#define SDL_zerop(x) memset((x), 0, sizeof(*(x)))
+#define SDL_zeroa(x) memset((x), 0, sizeof(x))
+
+#define SDL_malloc malloc
+#define SDL_calloc calloc
+#define SDL_free free
+#define SDL_memcpy memcpy
+#define SDL_memset memset
+#define SDL_memcmp memcmp
+#define SDL_strlen strlen
+#define SDL_strcasecmp strcasecmp
+#define SDL_snprintf snprintf
+#define SDL_atoi atoi
+
+extern bool SDL_SetError(const char *fmt, ...);
+extern const char *SDL_GetError(void);
+#define SDL_OutOfMemory() SDL_SetError("Out of memory")
+#define SDL_Unsupported() SDL_SetError("That operation is not supported")
+#define SDL_InvalidParamError(param) SDL_SetError("Parameter '%s' is invalid", (param))
+
+extern bool SDL_RectEmpty(const SDL_Rect *r);
+extern bool SDL_RectsEqual(const SDL_Rect *a, const SDL_Rect *b);
+extern bool SDL_HasRectIntersection(const SDL_Rect *a, const SDL_Rect *b);
+extern bool SDL_GetRectIntersection(const SDL_Rect *a, const SDL_Rect *b, SDL_Rect *result);
+extern void SDL_GetRectUnion(const SDL_Rect *a, const SDL_Rect *b, SDL_Rect *result);
+
+extern SDL_Surface *SDL_CreateSurfaceFrom(int w, int h, SDL_PixelFormat format, void *pixels, int pitch);
+extern void SDL_DestroySurface(SDL_Surface *surface);
+extern SDL_Palette *SDL_GetSurfacePalette(SDL_Surface *surface);
+extern const char *SDL_GetPixelFormatName(SDL_PixelFormat format);
+
+extern const char *SDL_GetHint(const char *name);
+extern bool SDL_GetHintBoolean(const char *name, bool default_value);
+typedef void (SDLCALL *SDL_HintCallback)(void *userdata, const char *name, const char *oldValue, const char *newValue);
+extern bool SDL_AddHintCallback(const char *name, SDL_HintCallback callback, void *userdata);
+extern void SDL_RemoveHintCallback(const char *name, SDL_HintCallback callback, void *userdata);
+
+extern bool SDL_HasProperty(SDL_PropertiesID props, const char *name);
+extern bool SDL_SetNumberProperty(SDL_PropertiesID props, const char *name, Sint64 value);
+extern Sint64 SDL_GetNumberProperty(SDL_PropertiesID props, const char *name, Sint64 default_value);
+
+extern Uint32 SDL_murmur3_32(const void *data, size_t len, Uint32 seed);
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef int gpio_num_t;
+
+typedef enum
+{
+    GPIO_INTR_POSEDGE = 1,
+} gpio_int_type_t;
+
+typedef enum
+{
+    GPIO_MODE_INPUT = 1,
+} gpio_mode_t;
+
+typedef struct
+{
+    uint64_t pin_bit_mask;
+    gpio_mode_t mode;
+    int pull_up_en;
+    int pull_down_en;
+    gpio_int_type_t intr_type;
+} gpio_config_t;
+
+extern esp_err_t gpio_config(const gpio_config_t *config);
+extern esp_err_t gpio_install_isr_service(int intr_alloc_flags);
+extern esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, void (*isr_handler)(void *), void *args);
+extern esp_err_t gpio_isr_handler_remove(gpio_num_t gpio_num);
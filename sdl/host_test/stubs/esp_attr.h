@@ -0,0 +1,5 @@
+/* Stand-in for ESP-IDF's section attributes, everything runs from ordinary memory on the host */
+#pragma once
+
+#define IRAM_ATTR
+#define DRAM_ATTR
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "esp_lcd_types.h"
+
+typedef struct
+{
+    int width;
+    int height;
+    unsigned int pixel_format;
+    bool has_touch;
+} esp_bsp_sdl_display_config_t;
@@ -0,0 +1,25 @@
+/* Stand-ins for the ESP-IDF APIs the driver uses, implemented by mocks.c */
+#pragma once
+
+#include <stdint.h>
+
+typedef int esp_err_t;
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_NO_MEM 0x101
+#define ESP_ERR_INVALID_ARG 0x102
+#define ESP_ERR_INVALID_STATE 0x103
+#define ESP_ERR_NOT_FOUND 0x105
+#define ESP_ERR_NOT_SUPPORTED 0x106
+
+extern void mock_check_failed(esp_err_t err, const char *expr, const char *file, int line);
+#define ESP_ERROR_CHECK(x)                                          \
+    do {                                                            \
+        esp_err_t err_ = (x);                                       \
+        if (err_ != ESP_OK) {                                       \
+            mock_check_failed(err_, #x, __FILE__, __LINE__);        \
+        }                                                           \
+    } while (0)
+
+extern const char *esp_err_to_name(esp_err_t err);
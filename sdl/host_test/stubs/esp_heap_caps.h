@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MALLOC_CAP_32BIT (1 << 1)
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_DMA (1 << 3)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+
+extern void *heap_caps_malloc(size_t size, uint32_t caps);
+extern void *heap_caps_calloc(size_t n, size_t size, uint32_t caps);
+extern void *heap_caps_aligned_alloc(size_t alignment, size_t size, uint32_t caps);
+extern void *heap_caps_aligned_calloc(size_t alignment, size_t n, size_t size, uint32_t caps);
+extern void heap_caps_free(void *ptr);
+extern size_t heap_caps_get_free_size(uint32_t caps);
+extern size_t heap_caps_get_largest_free_block(uint32_t caps);
@@ -0,0 +1,7 @@
+/* All host memory counts as internal and DMA-capable */
+#pragma once
+
+#include <stdbool.h>
+
+extern bool esp_ptr_dma_capable(const void *p);
+extern bool esp_ptr_external_ram(const void *p);
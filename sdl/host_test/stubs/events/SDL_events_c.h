@@ -0,0 +1,6 @@
+/* Stand-in for SDL's event internals */
+#pragma once
+
+#include "video/SDL_sysvideo.h"
+
+extern bool SDL_SendWindowEvent(SDL_Window *window, int windowevent, int data1, int data2);
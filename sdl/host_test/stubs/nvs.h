@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef uint32_t nvs_handle_t;
+
+typedef enum
+{
+    NVS_READONLY,
+    NVS_READWRITE,
+} nvs_open_mode_t;
+
+extern esp_err_t nvs_open(const char *name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle);
+extern esp_err_t nvs_get_u16(nvs_handle_t handle, const char *key, uint16_t *out_value);
+extern esp_err_t nvs_set_u16(nvs_handle_t handle, const char *key, uint16_t value);
+extern esp_err_t nvs_commit(nvs_handle_t handle);
+extern void nvs_close(nvs_handle_t handle);
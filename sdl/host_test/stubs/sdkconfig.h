@@ -0,0 +1,15 @@
+/* Kconfig defaults of the component, for a target with an SPI/i80 panel and no PPA */
+#pragma once
+
+#define CONFIG_SDL_ESPIDF_ROTATION 0
+#define CONFIG_SDL_ESPIDF_DIRTY_RECT_FULL_FRAME_PERCENT 50
+#define CONFIG_SDL_ESPIDF_DMA_RING_DEPTH 3
+#define CONFIG_SDL_ESPIDF_WINDOW_FORMAT "RGB565"
+#define CONFIG_SDL_ESPIDF_FRAME_BUDGET_US 0
+#define CONFIG_SDL_ESPIDF_TILE_SIZE 16
+#define CONFIG_SDL_ESPIDF_CHUNK_HEIGHT 4
+#define CONFIG_SDL_ESPIDF_CHUNK_HEIGHT_AUTO 1
+#define CONFIG_SDL_ESPIDF_CHUNK_HEIGHT_NVS 1
+#define CONFIG_SDL_ESPIDF_BAND_ROWS 32
+#define CONFIG_SDL_ESPIDF_TE_GPIO -1
+#define CONFIG_SDL_ESPIDF_VSYNC_TIMER_HZ 0
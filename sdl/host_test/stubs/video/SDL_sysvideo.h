@@ -0,0 +1,48 @@
+/* Stand-in for SDL's video internals, only the members the driver touches */
+#pragma once
+
+#include "SDL_internal.h"
+
+typedef struct SDL_WindowData SDL_WindowData;
+typedef struct SDL_DisplayData SDL_DisplayData;
+
+struct SDL_Window
+{
+    SDL_WindowID id;
+    int x, y;
+    int w, h;
+    SDL_Surface *surface;
+    SDL_WindowData *internal;
+};
+
+typedef struct SDL_VideoDisplay
+{
+    SDL_DisplayID id;
+    SDL_DisplayMode desktop_mode;
+    SDL_DisplayMode current_mode;
+    SDL_DisplayData *internal;
+} SDL_VideoDisplay;
+
+typedef struct SDL_VideoDevice SDL_VideoDevice;
+
+enum
+{
+    SDL_EVENT_WINDOW_MOVED = 0x205,
+    SDL_EVENT_WINDOW_RESIZED,
+    SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED,
+};
+
+extern SDL_VideoDevice *SDL_GetVideoDevice(void);
+extern SDL_VideoDisplay *SDL_GetVideoDisplayForWindow(SDL_Window *window);
+extern SDL_DisplayID SDL_GetDisplayForWindow(SDL_Window *window);
+extern void SDL_SetDesktopDisplayMode(SDL_VideoDisplay *display, const SDL_DisplayMode *mode);
+extern void SDL_SetCurrentDisplayMode(SDL_VideoDisplay *display, const SDL_DisplayMode *mode);
+extern SDL_PropertiesID SDL_GetWindowProperties(SDL_Window *window);
+extern bool SDL_GetWindowSizeInPixels(SDL_Window *window, int *w, int *h);
+extern void SDL_CheckWindowPixelSizeChanged(SDL_Window *window);
+extern SDL_Renderer *SDL_GetRenderer(SDL_Window *window);
+extern bool SDL_GetRenderLogicalPresentation(SDL_Renderer *renderer, int *w, int *h, SDL_RendererLogicalPresentation *mode);
+extern SDL_Renderer *SDL_CreateSoftwareRenderer(SDL_Surface *surface);
+extern void SDL_DestroyRenderer(SDL_Renderer *renderer);
+extern bool SDL_SetRenderViewport(SDL_Renderer *renderer, const SDL_Rect *rect);
+extern bool SDL_FlushRenderer(SDL_Renderer *renderer);
@@ -0,0 +1,113 @@
+/*
+ * RGB565 byte swap kernels against a plain per-pixel swap, over every source
+ * and destination alignment and the tail lengths the kernels special-case.
+ * Pixels around the destination must stay untouched. Each kernel's
+ * throughput over a frame-sized buffer is reported in Mpix/s.
+ */
+#include "mocks.h"
+#include "SDL_espidfconvert.h"
+#include "SDL3/SDL_esp-idf.h"
+#include <time.h>
+
+#define BUFFER_PIXELS 96
+#define GUARD 0xDEAD
+
+#define FRAME_PIXELS (320 * 240)
+// Frames converted per measurement, the fastest round counts
+#define TIMING_FRAMES 100
+#define TIMING_ROUNDS 5
+
+static void ExpectKernelSwaps(const char *name, ESPIDF_ConvertFunc convert, bool swap_bytes)
+{
+    uint16_t src[BUFFER_PIXELS] __attribute__((aligned(16)));
+    uint16_t dst[BUFFER_PIXELS] __attribute__((aligned(16)));
+
+    for (int i = 0; i < BUFFER_PIXELS; i++) {
+        src[i] = (uint16_t)(i * 0x9E37 + 0x1234);
+    }
+
+    for (int src_offset = 0; src_offset < 8; src_offset++) {
+        for (int dst_offset = 0; dst_offset < 8; dst_offset++) {
+            for (int count = 0; count <= BUFFER_PIXELS - 8; count++) {
+                int wrong = -1;
+
+                for (int i = 0; i < BUFFER_PIXELS; i++) {
+                    dst[i] = GUARD;
+                }
+                convert(&dst[dst_offset], &src[src_offset], count);
+
+                for (int i = 0; i < BUFFER_PIXELS && wrong < 0; i++) {
+                    uint16_t expected = GUARD;
+                    if (i >= dst_offset && i < dst_offset + count) {
+                        uint16_t p = src[src_offset + i - dst_offset];
+                        expected = swap_bytes ? (uint16_t)((p >> 8) | (p << 8)) : p;
+                    }
+                    if (dst[i] != expected) {
+                        wrong = i;
+                    }
+                }
+                MOCK_EXPECT(wrong < 0, "kernel %s matches the plain swap (src +%d, dst +%d, %d pixels), pixel %d differs",
+                            name, src_offset, dst_offset, count, wrong);
+                if (wrong >= 0) {
+                    return;
+                }
+            }
+        }
+    }
+}
+
+static int64_t HostNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// Throughput converting whole frames, as the flush does row after row
+static void ReportKernelSpeed(const char *name, ESPIDF_ConvertFunc convert)
+{
+    uint16_t *src = calloc(FRAME_PIXELS, sizeof(uint16_t));
+    uint16_t *dst = calloc(FRAME_PIXELS, sizeof(uint16_t));
+    int64_t best = INT64_MAX;
+
+    for (int i = 0; i < FRAME_PIXELS; i++) {
+        src[i] = (uint16_t)(i * 0x9E37);
+    }
+    for (int round = 0; round < TIMING_ROUNDS; round++) {
+        int64_t start = HostNs();
+        for (int i = 0; i < TIMING_FRAMES; i++) {
+            convert(dst, src, FRAME_PIXELS);
+        }
+        best = SDL_min(best, HostNs() - start);
+    }
+    printf("Kernel %-9s %8.1f Mpix/s\n", name, (double)FRAME_PIXELS * TIMING_FRAMES * 1000 / SDL_max(best, 1));
+    free(src);
+    free(dst);
+}
+
+int main(void)
+{
+    // The kernels the hint can name on this target, the default is the fastest one
+    static const char *const kernels[] = { "reference", "swar", NULL };
+
+    for (int k = 0; k < (int)SDL_arraysize(kernels); k++) {
+        mock_set_hint(SDL_HINT_ESPIDF_CONVERT_KERNEL, kernels[k]);
+        ExpectKernelSwaps(kernels[k] ? kernels[k] : "default", ESPIDF_SelectConvertKernel(true), true);
+    }
+    ExpectKernelSwaps("copy", ESPIDF_SelectConvertKernel(false), false);
+
+    for (int k = 0; k < (int)SDL_arraysize(kernels) - 1; k++) {
+        mock_set_hint(SDL_HINT_ESPIDF_CONVERT_KERNEL, kernels[k]);
+        ReportKernelSpeed(kernels[k], ESPIDF_SelectConvertKernel(true));
+    }
+    mock_set_hint(SDL_HINT_ESPIDF_CONVERT_KERNEL, NULL);
+    ReportKernelSpeed("copy", ESPIDF_SelectConvertKernel(false));
+
+    if (mock_failures) {
+        printf("%d expectations failed\n", mock_failures);
+        return 1;
+    }
+    printf("All expectations met\n");
+    return 0;
+}
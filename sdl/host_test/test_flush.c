@@ -0,0 +1,258 @@
+/*
+ * Chunk ring flush of an SPI/i80 panel: chunks go out in row order, cover the
+ * updated area, reuse a ring slot only after the panel read it and keep the
+ * ring full, and the panel ends up with the byte-swapped window surface. A
+ * full-frame flush over a bus as fast as the conversion is timed with one
+ * chunk in flight and with the whole ring, to show what the overlap gains.
+ */
+#include "mocks.h"
+#include "SDL_espidfwindow.h"
+#include "SDL_espidfframebuffer.h"
+#include "SDL_espidfscale.h"
+#include "SDL3/SDL_esp-idf.h"
+
+#define PANEL_W 32
+#define PANEL_H 24
+#define CHUNK_ROWS 4
+
+#define TIMING_W 320
+#define TIMING_H 240
+#define TIMING_CHUNK_ROWS 16
+// Full-frame flushes per measurement, the fastest one counts
+#define TIMING_FRAMES 5
+
+static SDL_DisplayData display;
+static SDL_Window window;
+static Uint16 *pixels;
+static int pitch;
+static int panel_w, panel_h;
+
+static void FillPattern(const SDL_Rect *rect, int seed)
+{
+    for (int y = rect->y; y < rect->y + rect->h; y++) {
+        for (int x = rect->x; x < rect->x + rect->w; x++) {
+            pixels[y * (pitch / 2) + x] = (Uint16)(x * 7 + y * 131 + seed * 1021);
+        }
+    }
+}
+
+static void ExpectPanelShowsSurface(const char *what)
+{
+    const Uint8 *ram = mock_panel_ram();
+    int mismatches = 0;
+
+    ESPIDF_WaitForTransfers(window.internal);
+    for (int y = 0; y < panel_h; y++) {
+        for (int x = 0; x < panel_w; x++) {
+            Uint16 pixel = pixels[y * (pitch / 2) + x];
+            const Uint8 *shown = ram + (y * panel_w + x) * 2;
+            // SPI panels take RGB565 big-endian
+            if (shown[0] != (pixel >> 8) || shown[1] != (pixel & 0xff)) {
+                mismatches++;
+            }
+        }
+    }
+    MOCK_EXPECT(mismatches == 0, "panel shows the surface after %s, %d pixels differ", what, mismatches);
+}
+
+// The transfers since the last reset send an area around rect in chunks of at most CHUNK_ROWS rows, top to bottom
+static void ExpectChunksCover(const SDL_Rect *rect, const char *what)
+{
+    int count = mock_panel_transfer_count();
+    int next_y;
+
+    MOCK_EXPECT(count > 0, "%s sent something", what);
+    if (count == 0) {
+        return;
+    }
+    next_y = mock_panel_transfer(0)->rect.y;
+    MOCK_EXPECT(next_y <= rect->y, "%s starts at row %d or above, not %d", what, rect->y, next_y);
+    for (int i = 0; i < count; i++) {
+        const mock_transfer *t = mock_panel_transfer(i);
+        MOCK_EXPECT(t->rect.y == next_y, "%s chunk %d starts at row %d, not %d", what, i, next_y, t->rect.y);
+        MOCK_EXPECT(t->rect.x <= rect->x && t->rect.x + t->rect.w >= rect->x + rect->w, "%s chunk %d spans columns %d+%d, not %d+%d",
+                    what, i, rect->x, rect->w, t->rect.x, t->rect.w);
+        MOCK_EXPECT(t->rect.h <= CHUNK_ROWS, "%s chunk %d has at most %d rows, not %d", what, i, CHUNK_ROWS, t->rect.h);
+        next_y = t->rect.y + t->rect.h;
+    }
+    MOCK_EXPECT(next_y >= rect->y + rect->h, "%s ends at row %d or below, not %d", what, rect->y + rect->h, next_y);
+}
+
+// Every ring slot is used, none beyond the ring, and the ring runs full
+static void ExpectRingUse(const char *what)
+{
+    const void *slots[CONFIG_SDL_ESPIDF_DMA_RING_DEPTH + 1];
+    int used = 0;
+
+    for (int i = 0; i < mock_panel_transfer_count(); i++) {
+        const void *data = mock_panel_transfer(i)->data;
+        int j = 0;
+        while (j < used && slots[j] != data) {
+            j++;
+        }
+        if (j == used && used < (int)SDL_arraysize(slots)) {
+            slots[used++] = data;
+        }
+    }
+    MOCK_EXPECT(used == CONFIG_SDL_ESPIDF_DMA_RING_DEPTH, "%s goes through the %d ring slots, used %d buffers",
+                what, CONFIG_SDL_ESPIDF_DMA_RING_DEPTH, used);
+    MOCK_EXPECT(mock_panel_max_in_flight() == CONFIG_SDL_ESPIDF_DMA_RING_DEPTH, "%s keeps %d chunks in flight, at most %d were",
+                what, CONFIG_SDL_ESPIDF_DMA_RING_DEPTH, mock_panel_max_in_flight());
+}
+
+static void Present(const SDL_Rect *rect, const char *what)
+{
+    ESPIDF_WaitForTransfers(window.internal);
+    mock_panel_reset_log();
+    MOCK_EXPECT(SDL_ESPIDF_UpdateWindowFramebuffer(NULL, &window, rect, 1), "%s presents: %s", what, SDL_GetError());
+}
+
+// A w x h window filling a w x h panel, sent in chunks of chunk_rows rows
+static bool OpenWindow(int w, int h, int chunk_rows)
+{
+    SDL_WindowData *data;
+    SDL_PixelFormat format;
+    void *surface_pixels;
+    static char hint[8];
+
+    panel_w = w;
+    panel_h = h;
+    SDL_zero(display);
+    display.panel_handle = (esp_lcd_panel_handle_t)&display;
+    display.panel_io_handle = (esp_lcd_panel_io_handle_t)&display.panel_io_handle;
+    display.config.width = w;
+    display.config.height = h;
+    display.config.pixel_format = SDL_PIXELFORMAT_RGB565;
+    display.panel_interface = ESPIDF_PANEL_IO;
+    display.primary = true;
+    mock_panel_init(&display, w, h, 2);
+
+    snprintf(hint, sizeof(hint), "%d", chunk_rows);
+    mock_set_hint(SDL_HINT_ESPIDF_CHUNK_HEIGHT, hint);
+
+    // As ESPIDF_CreateWindow sets the window up
+    data = calloc(1, sizeof(*data));
+    data->display = &display;
+    data->lcd_ring_depth = 1;
+    data->max_chunk_height = CONFIG_SDL_ESPIDF_CHUNK_HEIGHT;
+    data->full_frame_percent = CONFIG_SDL_ESPIDF_DIRTY_RECT_FULL_FRAME_PERCENT;
+    data->format = SDL_PIXELFORMAT_RGB565;
+    data->surface_align = ESPIDF_SURFACE_ALIGN;
+    ESPIDF_InitPresentation(data);
+    SDL_zero(window);
+    window.id = 1;
+    window.w = w;
+    window.h = h;
+    window.internal = data;
+
+    if (!SDL_ESPIDF_CreateWindowFramebuffer(NULL, &window, &format, &surface_pixels, &pitch)) {
+        printf("Creating the window framebuffer failed: %s\n", SDL_GetError());
+        free(data);
+        return false;
+    }
+    MOCK_EXPECT(format == SDL_PIXELFORMAT_RGB565, "an RGB565 window surface, not %s", SDL_GetPixelFormatName(format));
+    window.surface = SDL_CreateSurfaceFrom(w, h, format, surface_pixels, pitch);
+    pixels = surface_pixels;
+    return true;
+}
+
+static void CloseWindow(void)
+{
+    SDL_WindowData *data = window.internal;
+
+    ESPIDF_WaitForTransfers(data);
+    SDL_DestroySurface(window.surface);
+    SDL_ESPIDF_DestroyWindowFramebuffer(NULL, &window);
+    MOCK_EXPECT(mock_panel_in_flight() == 0, "nothing in flight once the framebuffer is gone, %d transfers are", mock_panel_in_flight());
+    free(data);
+    mock_panel_quit();
+}
+
+// Let only depth chunks be in flight, as ESPIDF_SetRingDepth does. Chunk buffers past depth stay allocated but unused.
+static void SetRingDepth(int depth)
+{
+    SDL_WindowData *data = window.internal;
+
+    ESPIDF_WaitForTransfers(data);
+    vSemaphoreDelete(data->lcd_semaphore);
+    data->lcd_semaphore = xSemaphoreCreateCounting(depth, depth);
+    data->lcd_ring_depth = depth;
+    data->chunk_ring_next = 0;
+}
+
+// Virtual time of the fastest of TIMING_FRAMES full-frame flushes, from the present until the panel has it all
+static int64_t TimeFullFrame(int *seed)
+{
+    const SDL_Rect full = { 0, 0, panel_w, panel_h };
+    int64_t best = INT64_MAX;
+
+    for (int i = 0; i < TIMING_FRAMES; i++) {
+        FillPattern(&full, ++*seed);
+        ESPIDF_WaitForTransfers(window.internal);
+        mock_panel_reset_log();
+        int64_t start = mock_clock_ns();
+        MOCK_EXPECT(SDL_ESPIDF_UpdateWindowFramebuffer(NULL, &window, &full, 1), "a timed frame presents: %s", SDL_GetError());
+        ESPIDF_WaitForTransfers(window.internal);
+        best = SDL_min(best, mock_clock_ns() - start);
+    }
+    return best;
+}
+
+int main(void)
+{
+    if (!OpenWindow(PANEL_W, PANEL_H, CHUNK_ROWS)) {
+        return 1;
+    }
+
+    const SDL_Rect full = { 0, 0, PANEL_W, PANEL_H };
+    FillPattern(&full, 1);
+    Present(&full, "the first frame");
+    ExpectChunksCover(&full, "the first frame");
+    ExpectRingUse("the first frame");
+    ExpectPanelShowsSurface("the first frame");
+
+    // Full-width rows below the full frame threshold, the tile diff may round them out to whole tiles
+    const SDL_Rect band = { 0, 9, PANEL_W, 5 };
+    FillPattern(&band, 2);
+    Present(&band, "a band update");
+    ExpectChunksCover(&band, "a band update");
+    ExpectPanelShowsSurface("a band update");
+
+    // Rows outside the changed tiles may be skipped, but whatever changed must reach the panel
+    const SDL_Rect small = { 3, 17, 9, 5 };
+    FillPattern(&small, 3);
+    Present(&small, "a small update");
+    ExpectPanelShowsSurface("a small update");
+
+    CloseWindow();
+
+    // The bus gets the speed at which sending a frame takes as long as converting it, where overlap gains the most
+    int seed = 0;
+    if (!OpenWindow(TIMING_W, TIMING_H, TIMING_CHUNK_ROWS)) {
+        return 1;
+    }
+    int64_t convert_ns = SDL_max(TimeFullFrame(&seed), 1);
+    int64_t frame_bytes = (int64_t)TIMING_W * TIMING_H * 2;
+    mock_panel_set_bus_speed(frame_bytes * 1000000000 / convert_ns);
+    int64_t ring_ns = TimeFullFrame(&seed);
+    SetRingDepth(1);
+    int64_t single_ns = TimeFullFrame(&seed);
+    ExpectPanelShowsSurface("the timed frames");
+    mock_panel_set_bus_speed(0);
+    CloseWindow();
+
+    printf("Full-frame flush of %dx%d in %d-row chunks, %d us of conversion and as long on the bus: "
+           "%d us with 1 chunk in flight, %d us with %d, %.2fx faster\n", TIMING_W, TIMING_H, TIMING_CHUNK_ROWS,
+           (int)(convert_ns / 1000), (int)(single_ns / 1000), (int)(ring_ns / 1000), CONFIG_SDL_ESPIDF_DMA_RING_DEPTH,
+           (double)single_ns / SDL_max(ring_ns, 1));
+    // Host timing is noisy, only a clear loss of overlap fails
+    MOCK_EXPECT(ring_ns * 5 < single_ns * 4, "a ring of %d chunks flushes at least 1.25x faster than a single chunk",
+                CONFIG_SDL_ESPIDF_DMA_RING_DEPTH);
+
+    if (mock_failures) {
+        printf("%d expectations failed\n", mock_failures);
+        return 1;
+    }
+    printf("All expectations met\n");
+    return 0;
+}
@@ -0,0 +1,176 @@
+/*
+ * Interlaced flush of an SPI/i80 panel with the tile diff on: "auto" starts
+ * after several full-frame presents, alternates the field, goes back to full
+ * presents with the first static frame and sends the skipped rows with it,
+ * after which unchanged frames are skipped again. Hint changes apply from the
+ * next present.
+ */
+#include "mocks.h"
+#include "SDL_espidfwindow.h"
+#include "SDL_espidfframebuffer.h"
+#include "SDL_espidfscale.h"
+#include "SDL3/SDL_esp-idf.h"
+
+#define PANEL_W 32
+#define PANEL_H 24
+#define CHUNK_ROWS 4
+// Presents in a row that send the whole frame before "auto" interlaces, as ESPIDF_INTERLACE_MOTION_FRAMES
+#define MOTION_FRAMES 4
+
+static SDL_DisplayData display;
+static SDL_Window window;
+static Uint16 *pixels;
+static int pitch;
+static const SDL_Rect full = { 0, 0, PANEL_W, PANEL_H };
+
+static void FillPattern(const SDL_Rect *rect, int seed)
+{
+    for (int y = rect->y; y < rect->y + rect->h; y++) {
+        for (int x = rect->x; x < rect->x + rect->w; x++) {
+            pixels[y * (pitch / 2) + x] = (Uint16)(x * 7 + y * 131 + seed * 1021);
+        }
+    }
+}
+
+static bool PanelShowsSurface(void)
+{
+    const Uint8 *ram = mock_panel_ram();
+
+    ESPIDF_WaitForTransfers(window.internal);
+    for (int y = 0; y < PANEL_H; y++) {
+        for (int x = 0; x < PANEL_W; x++) {
+            Uint16 pixel = pixels[y * (pitch / 2) + x];
+            const Uint8 *shown = ram + (y * PANEL_W + x) * 2;
+            if (shown[0] != (pixel >> 8) || shown[1] != (pixel & 0xff)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Parity of the rows the transfers since the last reset sent, -1 if they were not single rows of one parity
+static int SentField(void)
+{
+    int field = -1;
+
+    for (int i = 0; i < mock_panel_transfer_count(); i++) {
+        const mock_transfer *t = mock_panel_transfer(i);
+        if (t->rect.h != 1 || (field >= 0 && (t->rect.y & 1) != field)) {
+            return -1;
+        }
+        field = t->rect.y & 1;
+    }
+    return field;
+}
+
+static void Present(const SDL_Rect *rect, const char *what)
+{
+    ESPIDF_WaitForTransfers(window.internal);
+    mock_panel_reset_log();
+    MOCK_EXPECT(SDL_ESPIDF_UpdateWindowFramebuffer(NULL, &window, rect, 1), "%s presents: %s", what, SDL_GetError());
+    ESPIDF_WaitForTransfers(window.internal);
+}
+
+int main(void)
+{
+    SDL_WindowData *data;
+    SDL_PixelFormat format;
+    void *surface_pixels;
+    static char chunk_rows[8];
+    char what[64];
+    int seed = 0;
+    int field;
+
+    display.panel_handle = (esp_lcd_panel_handle_t)&display;
+    display.panel_io_handle = (esp_lcd_panel_io_handle_t)&display.panel_io_handle;
+    display.config.width = PANEL_W;
+    display.config.height = PANEL_H;
+    display.config.pixel_format = SDL_PIXELFORMAT_RGB565;
+    display.panel_interface = ESPIDF_PANEL_IO;
+    display.primary = true;
+    mock_panel_init(&display, PANEL_W, PANEL_H, 2);
+
+    snprintf(chunk_rows, sizeof(chunk_rows), "%d", CHUNK_ROWS);
+    mock_set_hint(SDL_HINT_ESPIDF_CHUNK_HEIGHT, chunk_rows);
+    mock_set_hint(SDL_HINT_ESPIDF_INTERLACE, "auto");
+
+    // As ESPIDF_CreateWindow sets the window up
+    data = calloc(1, sizeof(*data));
+    data->display = &display;
+    data->lcd_ring_depth = 1;
+    data->max_chunk_height = CONFIG_SDL_ESPIDF_CHUNK_HEIGHT;
+    data->full_frame_percent = CONFIG_SDL_ESPIDF_DIRTY_RECT_FULL_FRAME_PERCENT;
+    data->format = SDL_PIXELFORMAT_RGB565;
+    data->surface_align = ESPIDF_SURFACE_ALIGN;
+    ESPIDF_InitPresentation(data);
+    window.id = 1;
+    window.w = PANEL_W;
+    window.h = PANEL_H;
+    window.internal = data;
+
+    if (!SDL_ESPIDF_CreateWindowFramebuffer(NULL, &window, &format, &surface_pixels, &pitch)) {
+        printf("Creating the window framebuffer failed: %s\n", SDL_GetError());
+        return 1;
+    }
+    window.surface = SDL_CreateSurfaceFrom(PANEL_W, PANEL_H, format, surface_pixels, pitch);
+    pixels = surface_pixels;
+
+    // Motion: every frame changes every pixel
+    for (int i = 1; i < MOTION_FRAMES; i++) {
+        snprintf(what, sizeof(what), "moving frame %d", i);
+        FillPattern(&full, ++seed);
+        Present(&full, what);
+        MOCK_EXPECT(SentField() < 0, "%s is sent in full", what);
+        MOCK_EXPECT(PanelShowsSurface(), "panel shows %s", what);
+    }
+
+    FillPattern(&full, ++seed);
+    Present(&full, "the first interlaced frame");
+    field = SentField();
+    MOCK_EXPECT(field >= 0, "the first interlaced frame sends one field");
+    MOCK_EXPECT(mock_panel_transfer_count() == PANEL_H / 2, "the first interlaced frame sends %d rows, not %d",
+                PANEL_H / 2, mock_panel_transfer_count());
+
+    FillPattern(&full, ++seed);
+    Present(&full, "the second interlaced frame");
+    MOCK_EXPECT(SentField() == !field, "the second interlaced frame sends the other field");
+
+    // The motion stops, the tile diff finds nothing new but the rows the last field skipped still go out
+    Present(&full, "the first static frame");
+    MOCK_EXPECT(mock_panel_transfer_count() > 0 && SentField() < 0, "the first static frame sends the skipped rows progressively");
+    MOCK_EXPECT(PanelShowsSurface(), "panel shows the first static frame");
+
+    Present(&full, "the second static frame");
+    MOCK_EXPECT(mock_panel_transfer_count() == 0, "the tile diff skips the second static frame, %d transfers went out",
+                mock_panel_transfer_count());
+
+    // "off" applies from the next present, however long the motion lasts
+    mock_set_hint(SDL_HINT_ESPIDF_INTERLACE, "off");
+    for (int i = 1; i <= MOTION_FRAMES + 1; i++) {
+        snprintf(what, sizeof(what), "moving frame %d with interlacing off", i);
+        FillPattern(&full, ++seed);
+        Present(&full, what);
+        MOCK_EXPECT(SentField() < 0, "%s is sent in full", what);
+        MOCK_EXPECT(PanelShowsSurface(), "panel shows %s", what);
+    }
+
+    // "on" interlaces partial updates as well
+    mock_set_hint(SDL_HINT_ESPIDF_INTERLACE, "on");
+    const SDL_Rect small = { 3, 5, 9, 6 };
+    FillPattern(&small, ++seed);
+    Present(&small, "a small update with interlacing on");
+    MOCK_EXPECT(SentField() >= 0, "a small update with interlacing on sends one field");
+
+    SDL_DestroySurface(window.surface);
+    SDL_ESPIDF_DestroyWindowFramebuffer(NULL, &window);
+    free(data);
+    mock_panel_quit();
+
+    if (mock_failures) {
+        printf("%d expectations failed\n", mock_failures);
+        return 1;
+    }
+    printf("All expectations met\n");
+    return 0;
+}
@@ -0,0 +1,128 @@
+/*
+ * Logical presentations without a PPA: the flush only takes over those that
+ * a whole factor up to ESPIDF_CPU_SCALE_MAX shows exactly as the renderer
+ * would, every other one keeps the window size so the renderer scales it.
+ * Dynamic resolution only divides the logical size while the result still
+ * scales up exactly.
+ */
+#include "mocks.h"
+#include "SDL_espidfwindow.h"
+#include "SDL_espidfscale.h"
+
+#define PANEL_W 320
+#define PANEL_H 240
+
+static SDL_DisplayData display;
+static SDL_Window window;
+
+static const char *ModeName(SDL_RendererLogicalPresentation mode)
+{
+    switch (mode) {
+    case SDL_LOGICAL_PRESENTATION_STRETCH:
+        return "stretch";
+    case SDL_LOGICAL_PRESENTATION_LETTERBOX:
+        return "letterbox";
+    case SDL_LOGICAL_PRESENTATION_OVERSCAN:
+        return "overscan";
+    case SDL_LOGICAL_PRESENTATION_INTEGER_SCALE:
+        return "integer scale";
+    default:
+        return "disabled";
+    }
+}
+
+// The renderer scales the logical size itself into a surface of the window size
+static void ExpectRendererScales(int lw, int lh, SDL_RendererLogicalPresentation mode)
+{
+    int w, h;
+
+    mock_set_logical_presentation(lw, lh, mode);
+    ESPIDF_GetWindowSizeInPixels(NULL, &window, &w, &h);
+    MOCK_EXPECT(w == PANEL_W && h == PANEL_H, "%s at %dx%d renders at the window size, not %dx%d",
+                ModeName(mode), lw, lh, w, h);
+    ESPIDF_UpdatePresentation(&window, w, h);
+    MOCK_EXPECT(!ESPIDF_IsScaled(window.internal), "%s at %dx%d is not scaled again in the flush", ModeName(mode), lw, lh);
+}
+
+// The surface has the logical size and the flush scales it by whole factors onto rect
+static void ExpectFlushScales(int lw, int lh, SDL_RendererLogicalPresentation mode, int fx, int fy, SDL_Rect rect)
+{
+    int w, h;
+
+    mock_set_logical_presentation(lw, lh, mode);
+    ESPIDF_GetWindowSizeInPixels(NULL, &window, &w, &h);
+    MOCK_EXPECT(w == lw && h == lh, "%s at %dx%d renders at the logical size, not %dx%d", ModeName(mode), lw, lh, w, h);
+    ESPIDF_UpdatePresentation(&window, w, h);
+
+    const SDL_Rect shown = ESPIDF_GetPresentationRect(window.internal);
+    MOCK_EXPECT(ESPIDF_GetScaleX16(window.internal) == fx * ESPIDF_SCALE_ONE && ESPIDF_GetScaleY16(window.internal) == fy * ESPIDF_SCALE_ONE,
+                "%s at %dx%d is scaled %dx%d, not %d/16 x %d/16", ModeName(mode), lw, lh, fx, fy,
+                ESPIDF_GetScaleX16(window.internal), ESPIDF_GetScaleY16(window.internal));
+    MOCK_EXPECT(SDL_RectsEqual(&shown, &rect), "%s at %dx%d is shown at %d,%d %dx%d, not %d,%d %dx%d", ModeName(mode), lw, lh,
+                rect.x, rect.y, rect.w, rect.h, shown.x, shown.y, shown.w, shown.h);
+}
+
+// Largest render size divisor dynamic resolution may step to
+static int MaxRenderDiv(int lw, int lh, SDL_RendererLogicalPresentation mode)
+{
+    SDL_WindowData *data = window.internal;
+
+    mock_set_logical_presentation(lw, lh, mode);
+    data->render_div16 = 8 * ESPIDF_SCALE_ONE;
+    ESPIDF_FollowLogicalPresentation(&window);
+    return data->render_div16 / ESPIDF_SCALE_ONE;
+}
+
+int main(void)
+{
+    SDL_WindowData *data;
+
+    display.panel_handle = (esp_lcd_panel_handle_t)&display;
+    display.panel_io_handle = (esp_lcd_panel_io_handle_t)&display.panel_io_handle;
+    display.config.width = PANEL_W;
+    display.config.height = PANEL_H;
+    display.config.pixel_format = SDL_PIXELFORMAT_RGB565;
+    display.panel_interface = ESPIDF_PANEL_IO;
+    display.primary = true;
+    mock_panel_init(&display, PANEL_W, PANEL_H, 2);
+
+    data = calloc(1, sizeof(*data));
+    data->display = &display;
+    ESPIDF_InitPresentation(data);
+    window.id = 1;
+    window.w = PANEL_W;
+    window.h = PANEL_H;
+    window.internal = data;
+
+    // Fractional fits, more than the flush can replicate and larger than the display
+    ExpectRendererScales(200, 150, SDL_LOGICAL_PRESENTATION_LETTERBOX);
+    ExpectRendererScales(200, 150, SDL_LOGICAL_PRESENTATION_STRETCH);
+    ExpectRendererScales(80, 60, SDL_LOGICAL_PRESENTATION_LETTERBOX);
+    ExpectRendererScales(80, 60, SDL_LOGICAL_PRESENTATION_INTEGER_SCALE);
+    ExpectRendererScales(400, 300, SDL_LOGICAL_PRESENTATION_LETTERBOX);
+    ExpectRendererScales(400, 300, SDL_LOGICAL_PRESENTATION_INTEGER_SCALE);
+    // Overscan crops what a whole factor cannot fit exactly, the flush never crops
+    ExpectRendererScales(160, 100, SDL_LOGICAL_PRESENTATION_OVERSCAN);
+
+    ExpectFlushScales(160, 120, SDL_LOGICAL_PRESENTATION_LETTERBOX, 2, 2, (SDL_Rect){ 0, 0, 320, 240 });
+    ExpectFlushScales(160, 120, SDL_LOGICAL_PRESENTATION_OVERSCAN, 2, 2, (SDL_Rect){ 0, 0, 320, 240 });
+    ExpectFlushScales(160, 80, SDL_LOGICAL_PRESENTATION_STRETCH, 2, 3, (SDL_Rect){ 0, 0, 320, 240 });
+    ExpectFlushScales(150, 100, SDL_LOGICAL_PRESENTATION_INTEGER_SCALE, 2, 2, (SDL_Rect){ 10, 20, 300, 200 });
+    ExpectFlushScales(100, 80, SDL_LOGICAL_PRESENTATION_LETTERBOX, 3, 3, (SDL_Rect){ 10, 0, 300, 240 });
+    ExpectFlushScales(320, 240, SDL_LOGICAL_PRESENTATION_LETTERBOX, 1, 1, (SDL_Rect){ 0, 0, 320, 240 });
+
+    // 320x240 still fills the display at 1/2 and 1/3 of its size, 160x120 has no room beyond 2x
+    MOCK_EXPECT(MaxRenderDiv(320, 240, SDL_LOGICAL_PRESENTATION_LETTERBOX) == 3, "320x240 renders down to 1/3");
+    MOCK_EXPECT(MaxRenderDiv(160, 120, SDL_LOGICAL_PRESENTATION_LETTERBOX) == 1, "160x120 renders at its logical size");
+    MOCK_EXPECT(MaxRenderDiv(200, 150, SDL_LOGICAL_PRESENTATION_LETTERBOX) == 1, "200x150 renders at its logical size");
+
+    free(data);
+    mock_panel_quit();
+
+    if (mock_failures) {
+        printf("%d expectations failed\n", mock_failures);
+        return 1;
+    }
+    printf("All expectations met\n");
+    return 0;
+}
@@ -1,7 +1,356 @@
 /*
     ESP-IDF specific headers for direct access to some functions.
 */
+#ifndef SDL_esp_idf_h_
+#define SDL_esp_idf_h_
+
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_video.h>
+#include <SDL3/SDL_render.h>
+#include "esp_lcd_types.h"
+
+/**
+ * Share of the window area, in percent, above which the framebuffer flush
+ * stops sending individual dirty rectangles and pushes the whole frame.
+ *
+ * The default is CONFIG_SDL_ESPIDF_DIRTY_RECT_FULL_FRAME_PERCENT. The hint
+ * is read when the window framebuffer is created.
+ */
+#define SDL_HINT_ESPIDF_DIRTY_RECT_FULL_FRAME_PERCENT "SDL_ESPIDF_DIRTY_RECT_FULL_FRAME_PERCENT"
+
+/**
+ * Number of window rows sent per panel transaction, overriding the height
+ * picked by CONFIG_SDL_ESPIDF_CHUNK_HEIGHT_AUTO or stored in NVS. Capped like
+ * the picked height by the chunk buffers that fit in free DMA memory.
+ *
+ * The hint is read when the window framebuffer is created.
+ */
+#define SDL_HINT_ESPIDF_CHUNK_HEIGHT "SDL_ESPIDF_CHUNK_HEIGHT"
+
+/**
+ * RGB565 byte swap kernel used by the flush on SPI/i80 panels: "reference",
+ * "swar" or, on ESP32-S3, "pie".
+ *
+ * By default the fastest kernel is used. With
+ * CONFIG_SDL_ESPIDF_CONVERT_SELF_CHECK a kernel that does not produce the
+ * same output as "reference" on the running chip falls back to the next
+ * slower one. The hint is read when the window framebuffer is created.
+ */
+#define SDL_HINT_ESPIDF_CONVERT_KERNEL "SDL_ESPIDF_CONVERT_KERNEL"
+
+/**
+ * How RGB565 reaches SPI/i80 panels in their big endian byte order: "auto",
+ * "hardware" or "software".
+ *
+ * With "auto" (the default) the board gets to switch the panel or its bus to
+ * the CPU byte order through esp_bsp_sdl_set_cpu_byte_order(), and with
+ * CONFIG_SDL_ESPIDF_ST7789_LITTLE_ENDIAN the driver switches the panels that
+ * esp_bsp_sdl_panel_is_st7789() declares as ST7789s itself. "hardware" trusts
+ * that the BSP already did, "software" always swaps while flushing. Without a
+ * swap the flush copies rows, or sends them straight from a DMA-capable RGB565
+ * window surface. RGB and MIPI-DSI panels always take the CPU byte order. The
+ * hint is read when the video subsystem is initialized.
+ */
+#define SDL_HINT_ESPIDF_BYTE_ORDER "SDL_ESPIDF_BYTE_ORDER"
+
+/**
+ * Board hook, called once per SPI/i80 panel while the video subsystem is
+ * initialized. A BSP that can make the panel take RGB565 in the CPU (little
+ * endian) byte order, e.g. through an i80 bus set up to swap color bytes or
+ * the interface control register of the panel IC, does so and returns ESP_OK.
+ * The driver then stops swapping bytes on the CPU. The weak default returns
+ * ESP_ERR_NOT_SUPPORTED. Define it in the same source file as
+ * esp_bsp_sdl_init() so the linker picks it up.
+ */
+extern esp_err_t esp_bsp_sdl_set_cpu_byte_order(esp_lcd_panel_handle_t panel, esp_lcd_panel_io_handle_t panel_io);
+
+/**
+ * Board hook, called once per SPI/i80 panel the board did not switch through
+ * esp_bsp_sdl_set_cpu_byte_order() when the driver is built with
+ * CONFIG_SDL_ESPIDF_ST7789_LITTLE_ENDIAN. Returns true for ST7789 panels, which
+ * the driver then switches to little endian RGB565 through their RAMCTRL
+ * register. Other panels keep the byte swap on the CPU, the register means
+ * something else on other panel ICs. The weak default returns false. Define it
+ * in the same source file as esp_bsp_sdl_init() so the linker picks it up.
+ */
+extern bool esp_bsp_sdl_panel_is_st7789(esp_lcd_panel_handle_t panel, esp_lcd_panel_io_handle_t panel_io);
+
+/**
+ * Set to "0" to send every dirty rect even though the component was built
+ * with CONFIG_SDL_ESPIDF_TILE_DIFF.
+ *
+ * The hint is read when the window framebuffer is created.
+ */
+#define SDL_HINT_ESPIDF_TILE_DIFF "SDL_ESPIDF_TILE_DIFF"
+
+/**
+ * Set to "0" to copy frames into the panel even though the component was built
+ * with CONFIG_SDL_ESPIDF_DIRECT_FRAMEBUFFER.
+ *
+ * With direct frame buffers, the window surface is one of the RGB or MIPI-DSI
+ * panel frame buffers and SDL_RenderPresent() flips scan-out to it. The new
+ * back buffer holds the frame before the last one. The hint is read when the
+ * window framebuffer is created.
+ */
+#define SDL_HINT_ESPIDF_DIRECT_FRAMEBUFFER "SDL_ESPIDF_DIRECT_FRAMEBUFFER"
+
+/**
+ * Set to "0" to present synchronously even though the component was built
+ * with CONFIG_SDL_ESPIDF_ASYNC_PRESENT.
+ *
+ * With async present, SDL_RenderPresent() hands the finished frame to a flush
+ * task on the other core and returns at once with a new back buffer whose
+ * content is undefined, so the app must redraw the whole frame. The hint is
+ * read when the window framebuffer is created.
+ */
+#define SDL_HINT_ESPIDF_ASYNC_PRESENT "SDL_ESPIDF_ASYNC_PRESENT"
+
+/**
+ * Clockwise rotation of the display in degrees: "0", "90", "180" or "270".
+ * Overrides CONFIG_SDL_ESPIDF_ROTATION.
+ *
+ * The display mode and orientation report the rotated display, the panel or
+ * the PPA turns the window content and touch positions are mapped to match.
+ * The hint is read when the video subsystem is initialized.
+ */
+#define SDL_HINT_ESPIDF_ROTATION "SDL_ESPIDF_ROTATION"
+
+/**
+ * Pixel format of the window surface, with or without the SDL_PIXELFORMAT_
+ * prefix. Overrides CONFIG_SDL_ESPIDF_WINDOW_FORMAT.
+ *
+ * On the ESP32-P4 "RGB565", "ARGB8888", "XRGB8888", "RGB24" or "BGR24", the
+ * PPA converts other formats to RGB565 while flushing, so direct frame buffers
+ * are only used with RGB565. Other targets take "RGB565", "INDEX8", "RGB332"
+ * or "INDEX4MSB", expanded to RGB565 through a lookup table while flushing.
+ * Indexed formats take their colors from the palette of the window surface,
+ * see SDL_GetSurfacePalette(). Zero-copy builds only offer the panel format.
+ *
+ * Without the hint, 18/24-bit panels get a window surface in their own RGB24
+ * or BGR24 format when it fits in memory and an RGB565 one expanded while
+ * flushing otherwise, reported as the format of the display mode. Outside the
+ * ESP32-P4 the hint can only name one of those two there.
+ *
+ * The hint is read when the window framebuffer is created.
+ */
+#define SDL_HINT_ESPIDF_WINDOW_FORMAT "SDL_ESPIDF_WINDOW_FORMAT"
+
+/**
+ * Frame time budget in microseconds for the window on the primary display,
+ * "0" turns dynamic resolution off. Overrides CONFIG_SDL_ESPIDF_FRAME_BUDGET_US.
+ *
+ * Only applies while the window's renderer has a logical presentation the
+ * driver scales itself, see SDL_PROP_WINDOW_ESPIDF_RENDER_WIDTH_NUMBER. When
+ * rendering and flushing a frame take longer than the budget, the window
+ * surface is shrunk below the logical size and scaled up on its way to the
+ * panel, in 1/8 steps down to half the size on the ESP32-P4 and by whole
+ * factors on other targets. It grows back once the larger size is expected
+ * to fit. The renderer keeps app coordinates in the logical size, see
+ * SDL_PROP_WINDOW_ESPIDF_RENDER_WIDTH_NUMBER for the size rendered at. The
+ * wait for vsync does not count, so the refresh interval itself makes a good
+ * budget, and with async present only the render counts. The hint is read
+ * every 16 presents.
+ */
+#define SDL_HINT_ESPIDF_FRAME_BUDGET_US "SDL_ESPIDF_FRAME_BUDGET_US"
+
+/**
+ * Interlaced flush for SPI/i80 panels: "off", "on" or "auto". Overrides
+ * CONFIG_SDL_ESPIDF_INTERLACE_AUTO.
+ *
+ * An interlaced present sends only the even or only the odd rows of what
+ * changed, alternating between presents, each row in its own panel window.
+ * That halves the bytes per present at the cost of vertical detail while
+ * things move, the skipped rows follow with the next present. "auto"
+ * interlaces once several presents in a row sent the whole frame and goes
+ * back to full presents, including the rows still missing, with the first
+ * partial one. Scaled windows, windows turned by the PPA and band rendering
+ * are always sent in full. Changes take effect with the next present.
+ */
+#define SDL_HINT_ESPIDF_INTERLACE "SDL_ESPIDF_INTERLACE"
+
+/**
+ * Memory the window surface is allocated from: "default", "internal", "psram"
+ * or "dma".
+ *
+ * By default the surface goes where the build configuration needs it, DMA
+ * memory with CONFIG_SDL_ESPIDF_ZERO_COPY, PSRAM with
+ * CONFIG_SDL_ESPIDF_ZERO_COPY_PSRAM and any byte addressable memory otherwise.
+ * When the requested memory is exhausted the surface is placed anywhere and a
+ * warning is logged. Zero-copy surfaces only stay in PSRAM on the ESP32-S3,
+ * whose EDMA lets the panel read them, and move to DMA memory elsewhere.
+ *
+ * The hint is read when the window framebuffer is created.
+ */
+#define SDL_HINT_ESPIDF_SURFACE_MEMORY "SDL_ESPIDF_SURFACE_MEMORY"
+
+/**
+ * Alignment in bytes of the window surface pixels, a power of two of at least
+ * 4. The default of 64 keeps cache line write-backs off neighbouring data.
+ *
+ * The hint is read when the window framebuffer is created.
+ */
+#define SDL_HINT_ESPIDF_SURFACE_ALIGN "SDL_ESPIDF_SURFACE_ALIGN"
+
+/**
+ * Alignment in bytes of every window surface row, a power of two. By default
+ * rows are unpadded with CONFIG_SDL_ESPIDF_ZERO_COPY and padded to 4 bytes
+ * otherwise. Padded rows are sent to zero-copy panels one at a time.
+ *
+ * The hint is read when the window framebuffer is created.
+ */
+#define SDL_HINT_ESPIDF_SURFACE_PITCH_ALIGN "SDL_ESPIDF_SURFACE_PITCH_ALIGN"
+
+/**
+ * Window rows drawn per band by SDL_ESPIDF_RenderBands(). Overrides
+ * CONFIG_SDL_ESPIDF_BAND_ROWS.
+ *
+ * The hint is read when the bands are set up, on the first call and after the
+ * window size changed.
+ */
+#define SDL_HINT_ESPIDF_BAND_ROWS "SDL_ESPIDF_BAND_ROWS"
+
+/**
+ * Window creation properties that override the SDL_HINT_ESPIDF_SURFACE_*
+ * hints for one window. They may also be set on SDL_GetWindowProperties()
+ * before the window surface or renderer is created.
+ *
+ * - `SDL_PROP_WINDOW_CREATE_ESPIDF_SURFACE_CAPS_NUMBER`: MALLOC_CAP_* flags
+ *   the window surface is allocated with.
+ * - `SDL_PROP_WINDOW_CREATE_ESPIDF_SURFACE_ALIGN_NUMBER`: alignment of the
+ *   window surface pixels.
+ * - `SDL_PROP_WINDOW_CREATE_ESPIDF_SURFACE_PITCH_ALIGN_NUMBER`: alignment of
+ *   every window surface row.
+ */
+#define SDL_PROP_WINDOW_CREATE_ESPIDF_SURFACE_CAPS_NUMBER "SDL.window.create.espidf.surface_caps"
+#define SDL_PROP_WINDOW_CREATE_ESPIDF_SURFACE_ALIGN_NUMBER "SDL.window.create.espidf.surface_align"
+#define SDL_PROP_WINDOW_CREATE_ESPIDF_SURFACE_PITCH_ALIGN_NUMBER "SDL.window.create.espidf.surface_pitch_align"
+
+/**
+ * Frame fences. Every present of the window framebuffer gets a frame number,
+ * starting at 1. A frame counts as on the panel once it, or a newer frame that
+ * replaced it before it was sent, has been fully transmitted.
+ */
+extern Uint64 SDL_ESPIDF_GetLastSubmittedFrame(SDL_Window *window);
+extern bool SDL_ESPIDF_IsFrameOnPanel(SDL_Window *window, Uint64 frame);
+// timeout_ms < 0 waits forever, returns false on timeout
+extern bool SDL_ESPIDF_WaitForFrame(SDL_Window *window, Uint64 frame, Sint32 timeout_ms);
+
+/**
+ * Report a panel the app has set up as a further SDL display, next to the
+ * BSP panel which stays the primary display. Must be called before the video
+ * subsystem is initialized. panel_io is the IO handle of an SPI/i80 panel and
+ * NULL for RGB or MIPI-DSI panels, which must take RGB565.
+ *
+ * A window is shown on the display it is created on, e.g. with
+ * SDL_WINDOWPOS_CENTERED_DISPLAY(), one window per display. Rotation, scaling,
+ * touch, vsync, direct frame buffers and async present only apply to the
+ * primary display, windows on further panels are flushed synchronously.
+ */
+extern bool SDL_ESPIDF_RegisterPanel(esp_lcd_panel_handle_t panel, esp_lcd_panel_io_handle_t panel_io, int w, int h);
+
+/**
+ * Band rendering for boards that cannot hold a whole window surface. Only a
+ * band of SDL_HINT_ESPIDF_BAND_ROWS rows is allocated, in RGB565, and draw is
+ * called once per band with a software renderer whose viewport puts the band
+ * at window row y. The callback draws the whole frame as usual, the renderer
+ * clips it to the h rows of the band, and may skip anything outside them. Each
+ * band is sent to the panel as soon as it is drawn, so a frame costs one
+ * rasterization per band in exchange for the memory.
+ *
+ * The callback must not change the renderer viewport. A window renders either
+ * in bands or through its window surface or renderer, not both. Presents like
+ * a synchronous SDL_UpdateWindowSurface(), including vsync and frame fences.
+ */
+typedef void (SDLCALL *SDL_ESPIDF_DrawBandCallback)(void *userdata, SDL_Renderer *renderer, int y, int h);
+extern bool SDL_ESPIDF_RenderBands(SDL_Window *window, SDL_ESPIDF_DrawBandCallback draw, void *userdata);
+
+/**
+ * Scanline source for an RGB panel the BSP created with bounce buffers and no
+ * frame buffer, see CONFIG_SDL_ESPIDF_BOUNCE_BUFFER. Such a panel shows the
+ * window surface, read by the panel ISR every refresh, until fill is set.
+ * From then on fill produces every pixel: count RGB565 pixels of panel row y,
+ * starting at column x, into dst. A tile map or sprite layers need no window
+ * surface at all, saving the memory of a frame buffer.
+ *
+ * fill runs in the panel ISR once per span, it must be IRAM_ATTR, finish well
+ * within a bounce buffer's scan-out time and only touch internal RAM. NULL
+ * goes back to the window surface. Fails when the window's panel has a frame
+ * buffer.
+ */
+typedef void (SDLCALL *SDL_ESPIDF_ScanoutCallback)(void *userdata, Uint16 *dst, int x, int y, int count);
+extern bool SDL_ESPIDF_SetScanoutCallback(SDL_Window *window, SDL_ESPIDF_ScanoutCallback fill, void *userdata);
+
+/**
+ * Tile diff counters of the window: tiles sent to the panel and tiles skipped
+ * because they matched the last flushed frame. Returns false when the
+ * component was built without CONFIG_SDL_ESPIDF_TILE_DIFF.
+ */
+extern bool SDL_ESPIDF_GetTileDiffStats(SDL_Window *window, Uint64 *sent, Uint64 *skipped);
+
+/**
+ * Present pipeline statistics, published as read-only window properties when
+ * the component is built with CONFIG_SDL_ESPIDF_PRESENT_STATS. Stage times are
+ * in microseconds per present, as min, average and 99th percentile over the
+ * last 64 presents, and are updated every 16 presents. Counters run since the
+ * window surface was created.
+ *
+ * - `..._LOOKUP_*`: finding the window surface.
+ * - `..._CONVERT_*`: RGB565 byte swap or LUT expansion of the chunks.
+ * - `..._PPA_*`: PPA scaling, rotation and conversion (ESP32-P4).
+ * - `..._WAIT_*`: waiting for the panel to take or finish chunks.
+ * - `..._TOTAL_*`: the whole flush, including band drawing in band mode.
+ * - `SDL_PROP_WINDOW_ESPIDF_STATS_FRAMES_NUMBER`: presents flushed.
+ * - `SDL_PROP_WINDOW_ESPIDF_STATS_BYTES_NUMBER`: RGB565 bytes sent to the panel.
+ * - `SDL_PROP_WINDOW_ESPIDF_STATS_CHUNKS_NUMBER`: panel transfers issued.
+ */
+#define SDL_PROP_WINDOW_ESPIDF_STATS_LOOKUP_MIN_NUMBER "SDL.window.espidf.stats.lookup.min"
+#define SDL_PROP_WINDOW_ESPIDF_STATS_LOOKUP_AVG_NUMBER "SDL.window.espidf.stats.lookup.avg"
+#define SDL_PROP_WINDOW_ESPIDF_STATS_LOOKUP_P99_NUMBER "SDL.window.espidf.stats.lookup.p99"
+#define SDL_PROP_WINDOW_ESPIDF_STATS_CONVERT_MIN_NUMBER "SDL.window.espidf.stats.convert.min"
+#define SDL_PROP_WINDOW_ESPIDF_STATS_CONVERT_AVG_NUMBER "SDL.window.espidf.stats.convert.avg"
+#define SDL_PROP_WINDOW_ESPIDF_STATS_CONVERT_P99_NUMBER "SDL.window.espidf.stats.convert.p99"
+#define SDL_PROP_WINDOW_ESPIDF_STATS_PPA_MIN_NUMBER "SDL.window.espidf.stats.ppa.min"
+#define SDL_PROP_WINDOW_ESPIDF_STATS_PPA_AVG_NUMBER "SDL.window.espidf.stats.ppa.avg"
+#define SDL_PROP_WINDOW_ESPIDF_STATS_PPA_P99_NUMBER "SDL.window.espidf.stats.ppa.p99"
+#define SDL_PROP_WINDOW_ESPIDF_STATS_WAIT_MIN_NUMBER "SDL.window.espidf.stats.wait.min"
+#define SDL_PROP_WINDOW_ESPIDF_STATS_WAIT_AVG_NUMBER "SDL.window.espidf.stats.wait.avg"
+#define SDL_PROP_WINDOW_ESPIDF_STATS_WAIT_P99_NUMBER "SDL.window.espidf.stats.wait.p99"
+#define SDL_PROP_WINDOW_ESPIDF_STATS_TOTAL_MIN_NUMBER "SDL.window.espidf.stats.total.min"
+#define SDL_PROP_WINDOW_ESPIDF_STATS_TOTAL_AVG_NUMBER "SDL.window.espidf.stats.total.avg"
+#define SDL_PROP_WINDOW_ESPIDF_STATS_TOTAL_P99_NUMBER "SDL.window.espidf.stats.total.p99"
+#define SDL_PROP_WINDOW_ESPIDF_STATS_FRAMES_NUMBER "SDL.window.espidf.stats.frames"
+#define SDL_PROP_WINDOW_ESPIDF_STATS_BYTES_NUMBER "SDL.window.espidf.stats.bytes"
+#define SDL_PROP_WINDOW_ESPIDF_STATS_CHUNKS_NUMBER "SDL.window.espidf.stats.chunks"
+
+/**
+ * Size the window surface is rendered at, published on the window on the
+ * primary display. While the renderer has a logical presentation this is the
+ * logical size, or less under SDL_HINT_ESPIDF_FRAME_BUDGET_US, and the PPA or
+ * the flush scales it up to the display. The window keeps its size, only
+ * SDL_GetWindowSizeInPixels() reports the render size. Without a PPA the flush
+ * only replicates pixels 1, 2 or 3 times, so it takes over presentations that
+ * such factors show exactly as the renderer would. For any other logical size
+ * the surface keeps the window size and the renderer scales into it.
+ */
+#define SDL_PROP_WINDOW_ESPIDF_RENDER_WIDTH_NUMBER "SDL.window.espidf.render.width"
+#define SDL_PROP_WINDOW_ESPIDF_RENDER_HEIGHT_NUMBER "SDL.window.espidf.render.height"
+
+/**
+ * Panel refresh counters since boot: refreshes seen by the driver and
+ * refreshes by which vsync paced presents came late. Returns false when the
+ * panel has no refresh source, see CONFIG_SDL_ESPIDF_TE_GPIO.
+ */
+extern bool SDL_ESPIDF_GetVSyncStats(SDL_Window *window, Uint64 *refreshes, Uint64 *missed);
+
 #ifdef CONFIG_IDF_TARGET_ESP32P4
-// PPA helper function to scale image directly before streming it to HW
+/**
+ * Deprecated, use SDL_SetRenderLogicalPresentation() instead.
+ *
+ * Scales the window by factor_float on its way to the panel while the
+ * renderer has no logical presentation. Takes effect when the window
+ * framebuffer is created.
+ */
 void set_scale_factor(int factor, float factor_float);
-#endif
\ No newline at end of file
+#endif
+
+#endif /* SDL_esp_idf_h_ */
@@ -0,0 +1,116 @@
+#include "SDL_internal.h"
+
+#ifdef SDL_VIDEO_DRIVER_PRIVATE
+
+#include "video/SDL_sysvideo.h"
+#include "SDL_espidfband.h"
+#include "SDL_espidfframebuffer.h"
+#include "SDL_espidfpresent.h"
+#include "SDL_espidfvsync.h"
+#include "SDL_espidfwindow.h"
+#include "SDL_espidfstats.h"
+#include "SDL3/SDL_esp-idf.h"
+#include "esp_log.h"
+
+static const char *TAG = "SDL_espidfband";
+
+/*
+ * Band mode keeps only a few window rows in memory. The app's draw callback
+ * runs once per band on a software renderer whose viewport is shifted up by
+ * the band offset, so the renderer clips everything outside the band. Each
+ * band is flushed as soon as it is drawn and the buffer is reused for the
+ * next one.
+ */
+static bool ESPIDF_CreateBands(SDL_Window *window)
+{
+    SDL_WindowData *data = window->internal;
+    const char *hint = SDL_GetHint(SDL_HINT_ESPIDF_BAND_ROWS);
+    int rows = (hint && SDL_atoi(hint) > 0) ? SDL_atoi(hint) : CONFIG_SDL_ESPIDF_BAND_ROWS;
+    SDL_Surface *surface;
+    int w, h;
+
+    ESPIDF_DestroyBands(window);
+
+    surface = ESPIDF_CreateBandSurface(window, rows);
+    if (!surface) {
+        return false;
+    }
+    data->band_renderer = SDL_CreateSoftwareRenderer(surface);
+    if (!data->band_renderer) {
+        SDL_ESPIDF_DestroyWindowFramebuffer(SDL_GetVideoDevice(), window);
+        return false;
+    }
+
+    SDL_GetWindowSizeInPixels(window, &w, &h);
+    data->band_h = h;
+    ESP_LOGI(TAG, "Band of %d bytes, a frame is drawn %d times", surface->pitch * surface->h, (h + surface->h - 1) / surface->h);
+    return true;
+}
+
+void ESPIDF_DestroyBands(SDL_Window *window)
+{
+    SDL_WindowData *data = window->internal;
+
+    if (!data || !data->band_renderer) {
+        return;
+    }
+
+    // The renderer draws into the band surface, it goes first
+    SDL_DestroyRenderer(data->band_renderer);
+    data->band_renderer = NULL;
+    data->band_h = 0;
+    SDL_ESPIDF_DestroyWindowFramebuffer(SDL_GetVideoDevice(), window);
+}
+
+bool SDL_ESPIDF_RenderBands(SDL_Window *window, SDL_ESPIDF_DrawBandCallback draw, void *userdata)
+{
+    SDL_WindowData *data;
+    int w, h;
+
+    if (!window || !window->internal) {
+        return SDL_InvalidParamError("window");
+    }
+    if (!draw) {
+        return SDL_InvalidParamError("draw");
+    }
+
+    data = window->internal;
+    SDL_GetWindowSizeInPixels(window, &w, &h);
+    if (!data->band_renderer || data->surface->w != w || data->band_h != h) {
+        if (!ESPIDF_CreateBands(window)) {
+            return false;
+        }
+    }
+
+    SDL_Surface band = *data->surface;
+    int rows = band.h;
+
+    if (data->display->primary) {
+        ESPIDF_PaceFrame(0);
+    }
+    ESPIDF_STATS_BEGIN_FRAME(data);
+    for (int y = 0; y < h; y += rows) {
+        const SDL_Rect viewport = { 0, -y, w, h };
+
+        // The flush returns once the band may be drawn into again
+        band.h = SDL_min(rows, h - y);
+        SDL_SetRenderViewport(data->band_renderer, &viewport);
+        draw(userdata, data->band_renderer, y, band.h);
+        if (!SDL_FlushRenderer(data->band_renderer)) {
+            data->band_y = 0;
+            return false;
+        }
+
+        const SDL_Rect rect = { 0, 0, band.w, band.h };
+        data->band_y = y;
+        ESPIDF_FlushSurface(data, &band, &rect, 1);
+    }
+    data->band_y = 0;
+
+    ESPIDF_CompleteSyncFrame(data);
+    // The total includes drawing the bands
+    ESPIDF_STATS_END_FRAME(data);
+    return true;
+}
+
+#endif /* SDL_VIDEO_DRIVER_PRIVATE */
@@ -0,0 +1,8 @@
+#ifndef SDL_espidfband_h_
+#define SDL_espidfband_h_
+
+#include "SDL_internal.h"
+
+extern void ESPIDF_DestroyBands(SDL_Window *window);
+
+#endif /* SDL_espidfband_h_ */
@@ -0,0 +1,322 @@
+#include "SDL_internal.h"
+
+#ifdef SDL_VIDEO_DRIVER_PRIVATE
+
+#include <string.h>
+#include "video/SDL_sysvideo.h"
+#include "SDL_espidfbounce.h"
+#include "SDL_espidfshared.h"
+#include "SDL_espidfwindow.h"
+#include "SDL_espidfframebuffer.h"
+#include "SDL_espidfrotate.h"
+#include "SDL3/SDL_esp-idf.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#ifdef CONFIG_SDL_ESPIDF_BOUNCE_BUFFER
+#include "esp_lcd_panel_rgb.h"
+#endif
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#ifdef CONFIG_SDL_ESPIDF_BOUNCE_BUFFER
+
+static const char *TAG = "SDL_espidfbounce";
+
+// How long a present waits for the ISR to pick up the new front buffer before taking it over itself
+#define ESPIDF_BOUNCE_SWAP_TIMEOUT_MS 100
+
+/*
+ * The RGB panel has no frame buffer, the driver DMAs out of a few small
+ * bounce buffers in internal RAM and asks for each one to be refilled just
+ * before it is scanned out. The fill converts rows of the front window surface,
+ * which may sit in PSRAM and is then read in bursts of one bounce buffer, or
+ * asks the app's scanline callback. Presenting queues the back surface, the
+ * ISR switches to it when the next frame starts filling, so frames never tear.
+ */
+static SDL_DisplayData *bounce_panel = NULL;  // Primary RGB panel without a frame buffer, NULL if none
+static SDL_WindowData *bounce_data = NULL;    // Window whose surface is scanned out, NULL while there is none
+static uint8_t *bounce_pixels[2];
+static int bounce_buffers = 0;  // 2 when presents swap surfaces, 1 when the panel reads the only one
+static int bounce_w, bounce_h, bounce_pitch;
+static int panel_w;  // Kept past video quit, the panel ISR keeps filling black until the panel goes away
+
+// Read by the ISR, changed under bounce_lock
+static portMUX_TYPE bounce_lock = portMUX_INITIALIZER_UNLOCKED;
+static const uint8_t *front_pixels = NULL;
+static const uint8_t *pending_pixels = NULL;
+static SDL_ESPIDF_ScanoutCallback scanout_callback = NULL;
+static void *scanout_userdata = NULL;
+static volatile bool filling = false;
+static SemaphoreHandle_t swap_semaphore = NULL;  // Given from the ISR when it switched to the pending surface
+
+static IRAM_ATTR void ESPIDF_FillSurfaceRow(uint16_t *dst, const uint8_t *pixels, int x, int y, int count)
+{
+    // Panel pixels outside the window are black, the window sits at its panel position
+    int wy = pixels ? y - bounce_data->y : -1;
+    int x0 = pixels ? SDL_max(x, bounce_data->x) : x;
+    int x1 = pixels ? SDL_min(x + count, bounce_data->x + bounce_w) : x;
+
+    if (wy < 0 || wy >= bounce_h || x0 >= x1) {
+        memset(dst, 0, count * sizeof(uint16_t));
+        return;
+    }
+
+    const uint8_t *row = pixels + wy * bounce_pitch;
+    int wx = x0 - bounce_data->x;
+    uint16_t *out = dst + (x0 - x);
+    memset(dst, 0, (x0 - x) * sizeof(uint16_t));
+    if (bounce_data->expand_pixels) {
+        bounce_data->expand_pixels(out, row, wx, x1 - x0, bounce_data->expand_lut.colors);
+    } else {
+        // libc copies run from ROM, they stay usable with the flash cache off
+        memcpy(out, row + wx * sizeof(uint16_t), (x1 - x0) * sizeof(uint16_t));
+    }
+    memset(dst + (x1 - x), 0, (x + count - x1) * sizeof(uint16_t));
+}
+#endif /* CONFIG_SDL_ESPIDF_BOUNCE_BUFFER */
+
+IRAM_ATTR bool ESPIDF_FillBounceBufferFromISR(void *bounce_buf, int pos_px, int len_bytes)
+{
+#ifdef CONFIG_SDL_ESPIDF_BOUNCE_BUFFER
+    BaseType_t need_yield = pdFALSE;
+    uint16_t *dst = bounce_buf;
+    int count = len_bytes / sizeof(uint16_t);
+    int x = pos_px % panel_w;
+    int y = pos_px / panel_w;
+
+    portENTER_CRITICAL_ISR(&bounce_lock);
+    if (pos_px == 0 && pending_pixels) {
+        // A new frame starts, the queued surface is shown from its first row on
+        front_pixels = pending_pixels;
+        pending_pixels = NULL;
+        xSemaphoreGiveFromISR(swap_semaphore, &need_yield);
+    }
+    const uint8_t *pixels = front_pixels;
+    SDL_ESPIDF_ScanoutCallback callback = scanout_callback;
+    void *userdata = scanout_userdata;
+    filling = true;
+    portEXIT_CRITICAL_ISR(&bounce_lock);
+
+    // Bounce buffers need not start on a row, they are filled span by span within rows
+    while (count > 0) {
+        int n = SDL_min(count, panel_w - x);
+        if (callback) {
+            callback(userdata, dst, x, y, n);
+        } else {
+            ESPIDF_FillSurfaceRow(dst, pixels, x, y, n);
+        }
+        dst += n;
+        count -= n;
+        x = 0;
+        y++;
+    }
+
+    filling = false;
+    return need_yield == pdTRUE;
+#else
+    return false;
+#endif
+}
+
+void ESPIDF_InitBouncePresent(SDL_DisplayData *display)
+{
+#ifdef CONFIG_SDL_ESPIDF_BOUNCE_BUFFER
+    void *fb = NULL;
+
+    if (!display->primary || display->panel_interface != ESPIDF_PANEL_RGB) {
+        return;
+    }
+    if (esp_lcd_rgb_panel_get_frame_buffer(display->panel_handle, 1, &fb) == ESP_OK && fb) {
+        // The panel scans out of its own frame buffer, windows are copied into it
+        return;
+    }
+    if (ESPIDF_PanelBytesPerPixel(display) != 2) {
+        ESP_LOGW(TAG, "Bounce buffer fill only supports RGB565 panels");
+        return;
+    }
+
+    swap_semaphore = xSemaphoreCreateBinary();
+    if (!swap_semaphore) {
+        ESP_LOGW(TAG, "Failed to create bounce swap semaphore");
+        return;
+    }
+    if (ESPIDF_GetRotation() != 0) {
+        ESP_LOGW(TAG, "Panel without frame buffer, the display is shown unrotated");
+    }
+
+    // The panel needs its fill callback from the start, it shows black until a window is presented
+    bounce_panel = display;
+    panel_w = display->config.width;
+    ESPIDF_RegisterPanelCallbacks(display, NULL);
+    ESP_LOGI(TAG, "RGB panel has no frame buffer, filling its bounce buffers on demand");
+#endif
+}
+
+void ESPIDF_QuitBouncePresent(void)
+{
+#ifdef CONFIG_SDL_ESPIDF_BOUNCE_BUFFER
+    if (!bounce_panel) {
+        return;
+    }
+
+    // The ISR keeps filling black until the panel goes away
+    SDL_ESPIDF_SetScanoutCallback(NULL, NULL, NULL);
+    bounce_panel = NULL;
+    if (swap_semaphore) {
+        vSemaphoreDelete(swap_semaphore);
+        swap_semaphore = NULL;
+    }
+#endif
+}
+
+bool ESPIDF_IsBouncePanel(const SDL_DisplayData *display)
+{
+#ifdef CONFIG_SDL_ESPIDF_BOUNCE_BUFFER
+    return bounce_panel && display == bounce_panel;
+#else
+    return false;
+#endif
+}
+
+SDL_Surface *ESPIDF_CreateBounceSurface(SDL_WindowData *data, int w, int h, SDL_PixelFormat format)
+{
+#ifdef CONFIG_SDL_ESPIDF_BOUNCE_BUFFER
+    int pitch = ESPIDF_SurfacePitch(data, w, format);
+
+    if (SDL_BYTESPERPIXEL(format) > 2) {
+        SDL_SetError("Bounce buffer fill needs a window format of at most 16 bits");
+        return NULL;
+    }
+
+    // Presents swap two surfaces when both fit, a single one is read while the app draws into it
+    bounce_pixels[0] = ESPIDF_AllocSurfacePixels(data, (size_t)pitch * h);
+    if (!bounce_pixels[0]) {
+        SDL_SetError("Failed to allocate bounce window surface");
+        return NULL;
+    }
+    bounce_pixels[1] = ESPIDF_AllocSurfacePixels(data, (size_t)pitch * h);
+    bounce_buffers = bounce_pixels[1] ? 2 : 1;
+    if (bounce_buffers == 1) {
+        ESP_LOGW(TAG, "No room for a second window surface, presents may tear");
+    }
+
+    SDL_Surface *surface = SDL_CreateSurfaceFrom(w, h, format, bounce_pixels[bounce_buffers - 1], pitch);
+    if (!surface) {
+        ESPIDF_DestroyBouncePresent();
+        return NULL;
+    }
+
+    // The panel is an RGB panel, the LUT holds colors in CPU byte order
+    data->expand_pixels = ESPIDF_SelectExpandKernel(&data->expand_lut, format, false);
+    bounce_w = w;
+    bounce_h = h;
+    bounce_pitch = pitch;
+    bounce_data = data;
+
+    portENTER_CRITICAL(&bounce_lock);
+    // With two surfaces the first frame is black, with one the panel shows the app drawing
+    front_pixels = bounce_pixels[0];
+    pending_pixels = NULL;
+    portEXIT_CRITICAL(&bounce_lock);
+    xSemaphoreTake(swap_semaphore, 0);
+
+    ESP_LOGI(TAG, "Bounce buffers filled from %d window surface(s) of %d bytes", bounce_buffers, pitch * h);
+    return surface;
+#else
+    SDL_Unsupported();
+    return NULL;
+#endif
+}
+
+bool ESPIDF_IsBouncePresent(const SDL_WindowData *data)
+{
+#ifdef CONFIG_SDL_ESPIDF_BOUNCE_BUFFER
+    return bounce_buffers > 0 && bounce_data == data;
+#else
+    return false;
+#endif
+}
+
+void ESPIDF_BounceSurface(SDL_Window *window, SDL_Surface *surface)
+{
+#ifdef CONFIG_SDL_ESPIDF_BOUNCE_BUFFER
+    if (bounce_buffers == 1) {
+        // The panel reads the surface continuously, there is nothing to hand over
+        return;
+    }
+
+    portENTER_CRITICAL(&bounce_lock);
+    pending_pixels = surface->pixels;
+    portEXIT_CRITICAL(&bounce_lock);
+
+    // The old front surface is read until the next frame starts filling
+    if (xSemaphoreTake(swap_semaphore, pdMS_TO_TICKS(ESPIDF_BOUNCE_SWAP_TIMEOUT_MS)) != pdTRUE) {
+        ESP_LOGW(TAG, "No bounce buffer fill for %d ms, swapping anyway", ESPIDF_BOUNCE_SWAP_TIMEOUT_MS);
+        portENTER_CRITICAL(&bounce_lock);
+        front_pixels = surface->pixels;
+        pending_pixels = NULL;
+        portEXIT_CRITICAL(&bounce_lock);
+    }
+
+    // Hand the app the surface that was on screen, its content is the frame before the last one
+    uint8_t *back = (surface->pixels == bounce_pixels[0]) ? bounce_pixels[1] : bounce_pixels[0];
+    surface->pixels = back;
+    if (window->surface) {
+        window->surface->pixels = back;
+    }
+#endif
+}
+
+void ESPIDF_DestroyBouncePresent(void)
+{
+#ifdef CONFIG_SDL_ESPIDF_BOUNCE_BUFFER
+    if (bounce_buffers == 0) {
+        return;
+    }
+
+    // Stop the ISR reading the surfaces and let a fill in progress finish
+    portENTER_CRITICAL(&bounce_lock);
+    front_pixels = NULL;
+    pending_pixels = NULL;
+    portEXIT_CRITICAL(&bounce_lock);
+    while (filling) {
+        vTaskDelay(1);
+    }
+
+    // The surface itself belongs to the window data, it does not own these pixels
+    bounce_data = NULL;
+    bounce_buffers = 0;
+    for (int i = 0; i < 2; i++) {
+        if (bounce_pixels[i]) {
+            heap_caps_free(bounce_pixels[i]);
+            bounce_pixels[i] = NULL;
+        }
+    }
+#endif
+}
+
+bool SDL_ESPIDF_SetScanoutCallback(SDL_Window *window, SDL_ESPIDF_ScanoutCallback fill, void *userdata)
+{
+#ifdef CONFIG_SDL_ESPIDF_BOUNCE_BUFFER
+    // A NULL window only comes from video quit, which drops the callback
+    if (window && (!window->internal || !ESPIDF_IsBouncePanel(window->internal->display))) {
+        return SDL_SetError("Window's panel has a frame buffer, it does not scan out of bounce buffers");
+    }
+
+    portENTER_CRITICAL(&bounce_lock);
+    scanout_callback = fill;
+    scanout_userdata = userdata;
+    portEXIT_CRITICAL(&bounce_lock);
+
+    // The app may free the old userdata once this returns, a fill in progress still uses it
+    while (filling) {
+        vTaskDelay(1);
+    }
+    return true;
+#else
+    return SDL_Unsupported();
+#endif
+}
+
+#endif /* SDL_VIDEO_DRIVER_PRIVATE */
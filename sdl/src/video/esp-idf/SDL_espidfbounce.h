@@ -0,0 +1,21 @@
+#ifndef SDL_espidfbounce_h_
+#define SDL_espidfbounce_h_
+
+#include "SDL_internal.h"
+
+// Checks whether the primary RGB panel runs without a frame buffer and hooks up its bounce buffer fill
+extern void ESPIDF_InitBouncePresent(SDL_DisplayData *display);
+extern void ESPIDF_QuitBouncePresent(void);
+// The panel scans out of bounce buffers the driver fills, it has no frame buffer to copy windows into
+extern bool ESPIDF_IsBouncePanel(const SDL_DisplayData *display);
+
+// Window surface the panel ISR reads while it fills the bounce buffers, sets an error on failure
+extern SDL_Surface *ESPIDF_CreateBounceSurface(SDL_WindowData *data, int w, int h, SDL_PixelFormat format);
+extern bool ESPIDF_IsBouncePresent(const SDL_WindowData *data);
+extern void ESPIDF_BounceSurface(SDL_Window *window, SDL_Surface *surface);
+extern void ESPIDF_DestroyBouncePresent(void);
+
+// Called from the panel ISR for every bounce buffer, returns whether a task was woken
+extern bool ESPIDF_FillBounceBufferFromISR(void *bounce_buf, int pos_px, int len_bytes);
+
+#endif /* SDL_espidfbounce_h_ */
@@ -0,0 +1,169 @@
+#include "SDL_internal.h"
+
+#ifdef SDL_VIDEO_DRIVER_PRIVATE
+
+#include "video/SDL_sysvideo.h"
+#include "SDL_espidfframebuffer.h"
+#include "SDL_espidfchunk.h"
+#include "SDL_espidfwindow.h"
+#include "SDL_espidfshared.h"
+#include "SDL_espidfscale.h"
+#include "SDL3/SDL_esp-idf.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs.h"
+
+static const char *TAG = "SDL_espidfchunk";
+
+#define ESPIDF_CALIBRATION_ROUNDS 4
+#define ESPIDF_CALIBRATION_ROWS   16
+#define ESPIDF_CHUNK_NVS_NAMESPACE "sdl_espidf"
+
+// Chunks grow until the fixed cost of a transaction is at most 1/N of its total time
+#define ESPIDF_OVERHEAD_RATIO 10
+
+#ifdef CONFIG_SDL_ESPIDF_CHUNK_HEIGHT_NVS
+// NVS keys hold at most 15 characters, so panel, window size and scale are packed in hex
+static void ESPIDF_ChunkKey(const SDL_WindowData *data, char *key, size_t len, int w, int h)
+{
+    SDL_snprintf(key, len, "c%x%03x%03x%02x%02x", data->display->index & 0xF, w & 0xFFF, h & 0xFFF,
+                 ESPIDF_GetScaleX16(data) & 0xFF, ESPIDF_GetScaleY16(data) & 0xFF);
+}
+
+static int ESPIDF_LoadChunkHeight(const SDL_WindowData *data, int w, int h)
+{
+    nvs_handle_t nvs;
+    uint16_t rows = 0;
+    char key[16];
+
+    // NVS is optional, apps that never call nvs_flash_init() just recalibrate
+    if (nvs_open(ESPIDF_CHUNK_NVS_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK) {
+        return 0;
+    }
+    ESPIDF_ChunkKey(data, key, sizeof(key), w, h);
+    if (nvs_get_u16(nvs, key, &rows) != ESP_OK) {
+        rows = 0;
+    }
+    nvs_close(nvs);
+    return rows;
+}
+
+static void ESPIDF_StoreChunkHeight(const SDL_WindowData *data, int w, int h, int rows)
+{
+    nvs_handle_t nvs;
+    char key[16];
+
+    if (nvs_open(ESPIDF_CHUNK_NVS_NAMESPACE, NVS_READWRITE, &nvs) != ESP_OK) {
+        return;
+    }
+    ESPIDF_ChunkKey(data, key, sizeof(key), w, h);
+    if (nvs_set_u16(nvs, key, (uint16_t)rows) == ESP_OK) {
+        nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+}
+#endif /* CONFIG_SDL_ESPIDF_CHUNK_HEIGHT_NVS */
+
+#ifdef CONFIG_SDL_ESPIDF_CHUNK_HEIGHT_AUTO
+/*
+ * Time 1-row and n-row chunks of a w pixel wide window to split the
+ * per-transaction overhead from the cost per window row. The probes have the
+ * panel size real chunks get at the current scale and are drawn black into
+ * the window's own panel area, which still shows the blank new surface until
+ * its first flush covers it.
+ */
+static bool ESPIDF_CalibrateTransfers(SDL_WindowData *data, int w, int rows, int64_t *overhead_ns, int64_t *row_ns)
+{
+    const int probe_rows[2] = { 1, rows };
+    int64_t elapsed_ns[2];
+    SDL_Rect area = ESPIDF_GetPanelRect(data);
+    int scale_y16 = ESPIDF_GetScaleY16(data);
+    int out_w = (w * ESPIDF_GetScaleX16(data) + ESPIDF_SCALE_ONE - 1) / ESPIDF_SCALE_ONE;
+    int out_h = (rows * scale_y16 + ESPIDF_SCALE_ONE - 1) / ESPIDF_SCALE_ONE;
+    uint8_t *probe = heap_caps_calloc((size_t)out_w * out_h, ESPIDF_PanelBytesPerPixel(data->display), MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+
+    if (!probe) {
+        return false;
+    }
+
+    for (int k = 0; k < 2; k++) {
+        int probe_h = (probe_rows[k] * scale_y16 + ESPIDF_SCALE_ONE - 1) / ESPIDF_SCALE_ONE;
+
+        ESPIDF_WaitForTransfers(data);
+        int64_t start = esp_timer_get_time();
+        for (int i = 0; i < ESPIDF_CALIBRATION_ROUNDS; i++) {
+            ESPIDF_BeginTransfer(data);
+            ESP_ERROR_CHECK(esp_lcd_panel_draw_bitmap(data->display->panel_handle, area.x, area.y, area.x + out_w, area.y + probe_h, probe));
+            ESPIDF_WaitForTransfers(data);
+        }
+        elapsed_ns[k] = (esp_timer_get_time() - start) * 1000 / ESPIDF_CALIBRATION_ROUNDS;
+    }
+
+    heap_caps_free(probe);
+
+    *row_ns = SDL_max((elapsed_ns[1] - elapsed_ns[0]) / (rows - 1), 1);
+    *overhead_ns = SDL_max(elapsed_ns[0] - *row_ns, 0);
+    return true;
+}
+#endif /* CONFIG_SDL_ESPIDF_CHUNK_HEIGHT_AUTO */
+
+int ESPIDF_SelectChunkHeight(SDL_WindowData *data, int w, int h, size_t row_bytes)
+{
+    int rows = CONFIG_SDL_ESPIDF_CHUNK_HEIGHT;
+    int mem_rows = h;
+
+    const char *hint = SDL_GetHint(SDL_HINT_ESPIDF_CHUNK_HEIGHT);
+
+    if (row_bytes > 0) {
+        // Chunk buffers may take half of the free internal DMA memory, within the largest block
+        size_t budget = SDL_min(heap_caps_get_free_size(MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL) / 2,
+                                heap_caps_get_largest_free_block(MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL));
+        mem_rows = SDL_clamp((int)(budget / row_bytes), 1, h);
+    }
+    esp_idf_log_free_dma(data);
+
+    if (hint && SDL_atoi(hint) > 0) {
+        rows = SDL_min(SDL_atoi(hint), mem_rows);
+        ESP_LOGI(TAG, "Chunk height %d rows (hint, memory cap %d rows)", rows, mem_rows);
+        return rows;
+    }
+
+#ifdef CONFIG_SDL_ESPIDF_CHUNK_HEIGHT_AUTO
+    if (data->display->panel_interface != ESPIDF_PANEL_IO || row_bytes == 0) {
+        // Copies into a panel frame buffer and chunks sent from the surface itself have nothing to
+        // overlap with, fewer and larger chunks win
+        rows = mem_rows;
+        ESP_LOGI(TAG, "Chunk height %d rows (%s)", rows, row_bytes ? "frame buffer panel" : "no chunk buffer");
+        return rows;
+    }
+
+#ifdef CONFIG_SDL_ESPIDF_CHUNK_HEIGHT_NVS
+    int stored = ESPIDF_LoadChunkHeight(data, w, h);
+    if (stored > 0) {
+        rows = SDL_min(stored, mem_rows);
+        ESP_LOGI(TAG, "Chunk height %d rows (NVS)", rows);
+        return rows;
+    }
+#endif
+
+    int64_t overhead_ns, row_ns;
+    int probe = SDL_min(ESPIDF_CALIBRATION_ROWS, mem_rows);
+    if (probe > 1 && ESPIDF_CalibrateTransfers(data, w, probe, &overhead_ns, &row_ns)) {
+        int64_t wanted = ((ESPIDF_OVERHEAD_RATIO - 1) * overhead_ns + row_ns - 1) / row_ns;
+        rows = (int)SDL_clamp(wanted, 1, (int64_t)mem_rows);
+        ESP_LOGI(TAG, "Chunk height %d rows (overhead %d us, %d ns/row, memory cap %d rows)",
+                 rows, (int)(overhead_ns / 1000), (int)row_ns, mem_rows);
+#ifdef CONFIG_SDL_ESPIDF_CHUNK_HEIGHT_NVS
+        ESPIDF_StoreChunkHeight(data, w, h, rows);
+#endif
+        return rows;
+    }
+#endif /* CONFIG_SDL_ESPIDF_CHUNK_HEIGHT_AUTO */
+
+    rows = SDL_min(rows, mem_rows);
+    ESP_LOGI(TAG, "Chunk height %d rows", rows);
+    return rows;
+}
+
+#endif /* SDL_VIDEO_DRIVER_PRIVATE */
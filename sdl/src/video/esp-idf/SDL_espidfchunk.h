@@ -0,0 +1,9 @@
+#ifndef SDL_espidfchunk_h_
+#define SDL_espidfchunk_h_
+
+#include "SDL_internal.h"
+
+// row_bytes is the chunk buffer memory needed per row of chunk height, 0 if chunks need no buffer
+extern int ESPIDF_SelectChunkHeight(SDL_WindowData *data, int w, int h, size_t row_bytes);
+
+#endif /* SDL_espidfchunk_h_ */
@@ -0,0 +1,424 @@
+#include "SDL_internal.h"
+
+#ifdef SDL_VIDEO_DRIVER_PRIVATE
+
+#include "SDL_espidfconvert.h"
+#include "SDL3/SDL_esp-idf.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#ifdef CONFIG_SDL_ESPIDF_CONVERT_BENCHMARK
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#endif
+
+static const char *TAG = "SDL_espidfconvert";
+
+// Word access to pixel buffers that are declared as uint16_t
+typedef uint32_t __attribute__((may_alias)) ESPIDF_PixelPair;
+
+#define ESPIDF_SWAP16(p) ((uint16_t)(((p) >> 8) | ((p) << 8)))
+
+static IRAM_ATTR void ESPIDF_ConvertReference(uint16_t *dst, const uint16_t *src, int count)
+{
+    for (int i = 0; i < count; i++) {
+        dst[i] = ESPIDF_SWAP16(src[i]);
+    }
+}
+
+// Two pixels per 32-bit word, as long as source and destination share the same word alignment
+static IRAM_ATTR void ESPIDF_ConvertSWAR(uint16_t *dst, const uint16_t *src, int count)
+{
+    if ((((uintptr_t)src ^ (uintptr_t)dst) & 3) != 0) {
+        ESPIDF_ConvertReference(dst, src, count);
+        return;
+    }
+
+    if (((uintptr_t)dst & 3) != 0 && count > 0) {
+        *dst++ = ESPIDF_SWAP16(*src);
+        src++;
+        count--;
+    }
+
+    const ESPIDF_PixelPair *s = (const ESPIDF_PixelPair *)src;
+    ESPIDF_PixelPair *d = (ESPIDF_PixelPair *)dst;
+    for (int i = 0; i < count / 2; i++) {
+        uint32_t pair = s[i];
+        d[i] = ((pair >> 8) & 0x00FF00FF) | ((pair << 8) & 0xFF00FF00);
+    }
+
+    if (count & 1) {
+        dst[count - 1] = ESPIDF_SWAP16(src[count - 1]);
+    }
+}
+
+#ifdef CONFIG_IDF_TARGET_ESP32S3
+/*
+ * 16 pixels per iteration on the S3 vector unit: VUNZIP.8 splits 32 bytes into
+ * their low and high bytes, VZIP.8 with the operands exchanged interleaves them
+ * back high byte first. The 128-bit loads ignore the low address bits, so the
+ * vector loop only runs once both pointers reach a 16-byte boundary together.
+ */
+static IRAM_ATTR void ESPIDF_ConvertPIE(uint16_t *dst, const uint16_t *src, int count)
+{
+    if ((((uintptr_t)src ^ (uintptr_t)dst) & 15) != 0) {
+        ESPIDF_ConvertSWAR(dst, src, count);
+        return;
+    }
+
+    int head = SDL_min(count, (int)((16 - ((uintptr_t)dst & 15)) & 15) / (int)sizeof(uint16_t));
+    ESPIDF_ConvertSWAR(dst, src, head);
+    dst += head;
+    src += head;
+    count -= head;
+
+    int blocks = count / 16;
+    for (int i = 0; i < blocks; i++) {
+        __asm__ volatile(
+            "ee.vld.128.ip  q0, %0, 16\n\t"
+            "ee.vld.128.ip  q1, %0, 16\n\t"
+            "ee.vunzip.8    q0, q1\n\t"
+            "ee.vzip.8      q1, q0\n\t"
+            "ee.vst.128.ip  q1, %1, 16\n\t"
+            "ee.vst.128.ip  q0, %1, 16\n\t"
+            : "+r"(src), "+r"(dst)
+            :
+            : "memory");
+    }
+
+    ESPIDF_ConvertSWAR(dst, src, count - blocks * 16);
+}
+#endif /* CONFIG_IDF_TARGET_ESP32S3 */
+
+// The panel or its bus swaps in hardware, no per-pixel work is left
+static IRAM_ATTR void ESPIDF_ConvertCopy(uint16_t *dst, const uint16_t *src, int count)
+{
+    SDL_memcpy(dst, src, (size_t)count * sizeof(uint16_t));
+}
+
+typedef struct
+{
+    const char *name;
+    ESPIDF_ConvertFunc func;
+} ESPIDF_ConvertKernel;
+
+// Ordered from slowest to fastest
+static const ESPIDF_ConvertKernel convert_kernels[] = {
+    { "reference", ESPIDF_ConvertReference },
+    { "swar", ESPIDF_ConvertSWAR },
+#ifdef CONFIG_IDF_TARGET_ESP32S3
+    { "pie", ESPIDF_ConvertPIE },
+#endif
+};
+
+#ifdef CONFIG_SDL_ESPIDF_CONVERT_SELF_CHECK
+// Compare a kernel with the reference over every alignment and tail length it special-cases
+static bool ESPIDF_CheckConvertKernel(const ESPIDF_ConvertKernel *kernel)
+{
+    uint16_t src[80] __attribute__((aligned(16)));
+    uint16_t expected[80] __attribute__((aligned(16)));
+    uint16_t actual[80] __attribute__((aligned(16)));
+
+    for (int i = 0; i < (int)SDL_arraysize(src); i++) {
+        src[i] = (uint16_t)(i * 0x9E37 + 0x1234);
+    }
+
+    for (int src_offset = 0; src_offset < 8; src_offset++) {
+        for (int dst_offset = 0; dst_offset < 8; dst_offset++) {
+            for (int count = 0; count <= 64; count += (count < 20) ? 1 : 11) {
+                SDL_memset(expected, 0, sizeof(expected));
+                SDL_memset(actual, 0, sizeof(actual));
+                ESPIDF_ConvertReference(&expected[dst_offset], &src[src_offset], count);
+                kernel->func(&actual[dst_offset], &src[src_offset], count);
+                if (SDL_memcmp(expected, actual, sizeof(actual)) != 0) {
+                    ESP_LOGW(TAG, "Kernel %s differs from reference (src +%d, dst +%d, %d pixels)",
+                             kernel->name, src_offset, dst_offset, count);
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+#endif /* CONFIG_SDL_ESPIDF_CONVERT_SELF_CHECK */
+
+#ifdef CONFIG_SDL_ESPIDF_CONVERT_BENCHMARK
+#define ESPIDF_BENCHMARK_PIXELS (320 * 16)
+#define ESPIDF_BENCHMARK_ROUNDS 32
+
+static void ESPIDF_BenchmarkConvertKernels(void)
+{
+    uint16_t *src = heap_caps_aligned_alloc(16, ESPIDF_BENCHMARK_PIXELS * sizeof(uint16_t), MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    uint16_t *dst = heap_caps_aligned_alloc(16, ESPIDF_BENCHMARK_PIXELS * sizeof(uint16_t), MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+
+    if (src && dst) {
+        SDL_memset(src, 0x5A, ESPIDF_BENCHMARK_PIXELS * sizeof(uint16_t));
+        for (int k = 0; k < (int)SDL_arraysize(convert_kernels); k++) {
+            int64_t start = esp_timer_get_time();
+            for (int i = 0; i < ESPIDF_BENCHMARK_ROUNDS; i++) {
+                convert_kernels[k].func(dst, src, ESPIDF_BENCHMARK_PIXELS);
+            }
+            int64_t elapsed_us = SDL_max(esp_timer_get_time() - start, 1);
+            ESP_LOGI(TAG, "Kernel %-9s %d.%02d Mpix/s", convert_kernels[k].name,
+                     (int)((int64_t)ESPIDF_BENCHMARK_PIXELS * ESPIDF_BENCHMARK_ROUNDS / elapsed_us),
+                     (int)((int64_t)ESPIDF_BENCHMARK_PIXELS * ESPIDF_BENCHMARK_ROUNDS * 100 / elapsed_us % 100));
+        }
+    }
+
+    heap_caps_free(src);
+    heap_caps_free(dst);
+}
+#endif /* CONFIG_SDL_ESPIDF_CONVERT_BENCHMARK */
+
+ESPIDF_ConvertFunc ESPIDF_SelectConvertKernel(bool swap_bytes)
+{
+    int selected = (int)SDL_arraysize(convert_kernels) - 1;
+
+    if (!swap_bytes) {
+        ESP_LOGI(TAG, "Panel takes the CPU byte order, RGB565 rows are copied");
+        return ESPIDF_ConvertCopy;
+    }
+
+#ifdef CONFIG_SDL_ESPIDF_CONVERT_BENCHMARK
+    ESPIDF_BenchmarkConvertKernels();
+#endif
+
+    const char *hint = SDL_GetHint(SDL_HINT_ESPIDF_CONVERT_KERNEL);
+    if (hint) {
+        for (int k = 0; k < (int)SDL_arraysize(convert_kernels); k++) {
+            if (SDL_strcasecmp(hint, convert_kernels[k].name) == 0) {
+                selected = k;
+                break;
+            }
+        }
+    }
+
+#ifdef CONFIG_SDL_ESPIDF_CONVERT_SELF_CHECK
+    // A kernel that does not match the reference on this chip is never used
+    while (selected > 0 && !ESPIDF_CheckConvertKernel(&convert_kernels[selected])) {
+        selected--;
+    }
+#endif
+
+    ESP_LOGI(TAG, "RGB565 conversion kernel: %s", convert_kernels[selected].name);
+    return convert_kernels[selected].func;
+}
+
+/*
+ * 18/24-bit panels take three bytes per pixel in the order of their RGB24 or
+ * BGR24 format, 18-bit panels read the top six bits of each. Window surfaces
+ * in that format are copied, RGB565 ones are widened with the low bits
+ * replicated so white stays white.
+ */
+#define ESPIDF_EXPAND5(v) ((uint8_t)(((v) << 3) | ((v) >> 2)))
+#define ESPIDF_EXPAND6(v) ((uint8_t)(((v) << 2) | ((v) >> 4)))
+
+static IRAM_ATTR void ESPIDF_Copy24(uint8_t *dst, const uint8_t *src, int count)
+{
+    SDL_memcpy(dst, src, (size_t)count * 3);
+}
+
+// Widen one RGB565 pixel, first and last are the bytes that go out first and last
+static inline void ESPIDF_Unpack565(uint16_t p, bool bgr, uint8_t *first, uint8_t *green, uint8_t *last)
+{
+    uint8_t r = ESPIDF_EXPAND5(p >> 11);
+    uint8_t b = ESPIDF_EXPAND5(p & 0x1F);
+
+    *first = bgr ? b : r;
+    *green = ESPIDF_EXPAND6((p >> 5) & 0x3F);
+    *last = bgr ? r : b;
+}
+
+// Four pixels per three 32-bit stores once the destination is word aligned
+static inline void ESPIDF_ExpandRGB565(uint8_t *dst, const uint16_t *src, int count, bool bgr)
+{
+    uint8_t c[12];
+
+    while (((uintptr_t)dst & 3) != 0 && count > 0) {
+        ESPIDF_Unpack565(*src++, bgr, &dst[0], &dst[1], &dst[2]);
+        dst += 3;
+        count--;
+    }
+
+    ESPIDF_PixelPair *d = (ESPIDF_PixelPair *)dst;
+    for (int i = 0; i < count / 4; i++) {
+        for (int k = 0; k < 4; k++) {
+            ESPIDF_Unpack565(src[k], bgr, &c[3 * k], &c[3 * k + 1], &c[3 * k + 2]);
+        }
+        d[0] = c[0] | (c[1] << 8) | (c[2] << 16) | ((uint32_t)c[3] << 24);
+        d[1] = c[4] | (c[5] << 8) | (c[6] << 16) | ((uint32_t)c[7] << 24);
+        d[2] = c[8] | (c[9] << 8) | (c[10] << 16) | ((uint32_t)c[11] << 24);
+        d += 3;
+        src += 4;
+    }
+
+    dst = (uint8_t *)d;
+    for (int i = 0; i < (count & 3); i++) {
+        ESPIDF_Unpack565(src[i], bgr, &dst[3 * i], &dst[3 * i + 1], &dst[3 * i + 2]);
+    }
+}
+
+static IRAM_ATTR void ESPIDF_ExpandRGB565ToRGB24(uint8_t *dst, const uint8_t *src, int count)
+{
+    ESPIDF_ExpandRGB565(dst, (const uint16_t *)src, count, false);
+}
+
+static IRAM_ATTR void ESPIDF_ExpandRGB565ToBGR24(uint8_t *dst, const uint8_t *src, int count)
+{
+    ESPIDF_ExpandRGB565(dst, (const uint16_t *)src, count, true);
+}
+
+ESPIDF_Convert24Func ESPIDF_SelectConvert24Kernel(SDL_PixelFormat window_format, SDL_PixelFormat panel_format)
+{
+    if (window_format == panel_format) {
+        ESP_LOGI(TAG, "Window surface is in the %s panel format, rows are copied", SDL_GetPixelFormatName(panel_format));
+        return ESPIDF_Copy24;
+    }
+
+    ESP_LOGI(TAG, "RGB565 rows are expanded to %s for the panel", SDL_GetPixelFormatName(panel_format));
+    return (panel_format == SDL_PIXELFORMAT_BGR24) ? ESPIDF_ExpandRGB565ToBGR24 : ESPIDF_ExpandRGB565ToRGB24;
+}
+
+/*
+ * Pixel i is read from (factor - 1) * count + i and written from i * factor
+ * on, which never passes a pixel that has not been read yet, so the row is
+ * widened without a second buffer.
+ */
+IRAM_ATTR void ESPIDF_ReplicatePixels(uint8_t *row, int count, int factor, int bytes_per_pixel)
+{
+    const uint8_t *src = row + (size_t)(factor - 1) * count * bytes_per_pixel;
+
+    if (bytes_per_pixel == 3) {
+        for (int i = 0; i < count; i++) {
+            uint8_t c0 = src[3 * i], c1 = src[3 * i + 1], c2 = src[3 * i + 2];
+            for (int k = 0; k < factor; k++) {
+                uint8_t *dst = row + (i * factor + k) * 3;
+                dst[0] = c0;
+                dst[1] = c1;
+                dst[2] = c2;
+            }
+        }
+        return;
+    }
+
+    const uint16_t *src16 = (const uint16_t *)src;
+    uint16_t *dst16 = (uint16_t *)row;
+    if (factor == 2 && ((uintptr_t)row & 3) == 0) {
+        // One word store per pixel
+        ESPIDF_PixelPair *d = (ESPIDF_PixelPair *)row;
+        for (int i = 0; i < count; i++) {
+            uint32_t p = src16[i];
+            d[i] = p | (p << 16);
+        }
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        uint16_t p = src16[i];
+        for (int k = 0; k < factor; k++) {
+            dst16[i * factor + k] = p;
+        }
+    }
+}
+
+/*
+ * Reduced-depth window surfaces are expanded through a LUT of RGB565 colors
+ * that are already in panel byte order, so no byte swap follows. The LUT lives
+ * in the window data, which is kept in internal RAM.
+ */
+static uint16_t ESPIDF_PanelRGB565(const ESPIDF_ExpandLUT *lut, Uint8 r, Uint8 g, Uint8 b)
+{
+    uint16_t color = (uint16_t)(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+
+    return lut->swap_bytes ? ESPIDF_SWAP16(color) : color;
+}
+
+// 3-3-2 colors for RGB332 and untouched INDEX8 palettes, a gray ramp for INDEX4MSB
+static void ESPIDF_LoadDefaultExpandLUT(ESPIDF_ExpandLUT *lut)
+{
+    if (lut->format == SDL_PIXELFORMAT_INDEX4MSB) {
+        for (int i = 0; i < 16; i++) {
+            lut->colors[i] = ESPIDF_PanelRGB565(lut, (Uint8)(i * 17), (Uint8)(i * 17), (Uint8)(i * 17));
+        }
+        return;
+    }
+    for (int i = 0; i < 256; i++) {
+        lut->colors[i] = ESPIDF_PanelRGB565(lut, (Uint8)(((i >> 5) & 7) * 255 / 7), (Uint8)(((i >> 2) & 7) * 255 / 7), (Uint8)((i & 3) * 85));
+    }
+}
+
+static IRAM_ATTR void ESPIDF_Expand8(uint16_t *dst, const uint8_t *row, int x, int count, const uint16_t *colors)
+{
+    const uint8_t *src = row + x;
+
+    for (int i = 0; i < count; i++) {
+        dst[i] = colors[src[i]];
+    }
+}
+
+// Two pixels per byte, the high nibble first
+static IRAM_ATTR void ESPIDF_Expand4(uint16_t *dst, const uint8_t *row, int x, int count, const uint16_t *colors)
+{
+    const uint8_t *src = row + x / 2;
+
+    if ((x & 1) && count > 0) {
+        *dst++ = colors[*src++ & 0x0F];
+        count--;
+    }
+    for (int i = 0; i < count / 2; i++) {
+        uint8_t pair = src[i];
+        dst[2 * i] = colors[pair >> 4];
+        dst[2 * i + 1] = colors[pair & 0x0F];
+    }
+    if (count & 1) {
+        dst[count - 1] = colors[src[count / 2] >> 4];
+    }
+}
+
+ESPIDF_ExpandFunc ESPIDF_SelectExpandKernel(ESPIDF_ExpandLUT *lut, SDL_PixelFormat format, bool swap_bytes)
+{
+    lut->format = format;
+    lut->swap_bytes = swap_bytes;
+    lut->palette = NULL;
+    lut->palette_version = 0;
+
+    switch (format) {
+    case SDL_PIXELFORMAT_INDEX8:
+    case SDL_PIXELFORMAT_RGB332:
+        ESPIDF_LoadDefaultExpandLUT(lut);
+        return ESPIDF_Expand8;
+    case SDL_PIXELFORMAT_INDEX4MSB:
+        ESPIDF_LoadDefaultExpandLUT(lut);
+        return ESPIDF_Expand4;
+    default:
+        return NULL;
+    }
+}
+
+bool ESPIDF_ExpandPaletteChanged(const ESPIDF_ExpandLUT *lut, const SDL_Palette *palette)
+{
+    if (!SDL_ISPIXELFORMAT_INDEXED(lut->format) || !palette) {
+        return false;
+    }
+    return palette != lut->palette || palette->version != lut->palette_version;
+}
+
+bool ESPIDF_UpdateExpandPalette(ESPIDF_ExpandLUT *lut, const SDL_Palette *palette)
+{
+    if (!ESPIDF_ExpandPaletteChanged(lut, palette)) {
+        return false;
+    }
+
+    lut->palette = palette;
+    lut->palette_version = palette->version;
+    if (palette->version <= 1) {
+        // SDL_CreatePalette leaves every color white, until the app sets its own the default colors are shown
+        ESPIDF_LoadDefaultExpandLUT(lut);
+    } else {
+        int ncolors = SDL_min(palette->ncolors, (lut->format == SDL_PIXELFORMAT_INDEX4MSB) ? 16 : 256);
+        for (int i = 0; i < ncolors; i++) {
+            lut->colors[i] = ESPIDF_PanelRGB565(lut, palette->colors[i].r, palette->colors[i].g, palette->colors[i].b);
+        }
+    }
+    return true;
+}
+
+#endif /* SDL_VIDEO_DRIVER_PRIVATE */
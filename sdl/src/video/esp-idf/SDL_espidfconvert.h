@@ -0,0 +1,44 @@
+#ifndef SDL_espidfconvert_h_
+#define SDL_espidfconvert_h_
+
+#include "SDL_internal.h"
+
+// Convert count RGB565 pixels from surface byte order to the byte order of the panel
+typedef void (*ESPIDF_ConvertFunc)(uint16_t *dst, const uint16_t *src, int count);
+
+// Pick the fastest byte swap kernel, or the one named by SDL_HINT_ESPIDF_CONVERT_KERNEL, checked
+// against the reference with CONFIG_SDL_ESPIDF_CONVERT_SELF_CHECK. Panels that take the CPU byte
+// order get a plain copy.
+extern ESPIDF_ConvertFunc ESPIDF_SelectConvertKernel(bool swap_bytes);
+
+// Write count pixels of a window row as the three bytes per pixel an 18/24-bit panel takes
+typedef void (*ESPIDF_Convert24Func)(uint8_t *dst, const uint8_t *src, int count);
+
+// Copy kernel for window surfaces in the panel format, RGB565 expansion kernel otherwise
+extern ESPIDF_Convert24Func ESPIDF_SelectConvert24Kernel(SDL_PixelFormat window_format, SDL_PixelFormat panel_format);
+
+// Nearest-neighbour upscale in place: count converted pixels stored at the end of a row of
+// count * factor pixels are widened to fill the whole row
+extern void ESPIDF_ReplicatePixels(uint8_t *row, int count, int factor, int bytes_per_pixel);
+
+// RGB565 colors in panel byte order for every value of a reduced-depth pixel
+typedef struct ESPIDF_ExpandLUT
+{
+    uint16_t colors[256];
+    SDL_PixelFormat format;
+    bool swap_bytes;             // Colors are big endian for SPI/i80 panels
+    const SDL_Palette *palette;  // Palette the colors were last loaded from
+    Uint32 palette_version;
+} ESPIDF_ExpandLUT;
+
+// Expand count pixels of a reduced-depth row, starting at pixel x, to RGB565 in panel byte order
+typedef void (*ESPIDF_ExpandFunc)(uint16_t *dst, const uint8_t *row, int x, int count, const uint16_t *colors);
+
+// Expansion kernel for INDEX8, RGB332 or INDEX4MSB window surfaces, NULL for RGB565
+extern ESPIDF_ExpandFunc ESPIDF_SelectExpandKernel(ESPIDF_ExpandLUT *lut, SDL_PixelFormat format, bool swap_bytes);
+// Whether the palette of an indexed window surface differs from the one the LUT was loaded from
+extern bool ESPIDF_ExpandPaletteChanged(const ESPIDF_ExpandLUT *lut, const SDL_Palette *palette);
+// Reload the LUT of an indexed window surface when its palette changed, returns true if it did
+extern bool ESPIDF_UpdateExpandPalette(ESPIDF_ExpandLUT *lut, const SDL_Palette *palette);
+
+#endif /* SDL_espidfconvert_h_ */
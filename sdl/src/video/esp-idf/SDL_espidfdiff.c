@@ -0,0 +1,195 @@
+#include "SDL_internal.h"
+
+#ifdef SDL_VIDEO_DRIVER_PRIVATE
+
+#include "video/SDL_sysvideo.h"
+#include "SDL_espidfframebuffer.h"
+#include "SDL_espidfdiff.h"
+#include "SDL_espidfwindow.h"
+#include "SDL3/SDL_esp-idf.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+#ifdef CONFIG_SDL_ESPIDF_TILE_DIFF
+
+static const char *TAG = "SDL_espidfdiff";
+
+#define ESPIDF_TILE_SIZE CONFIG_SDL_ESPIDF_TILE_SIZE
+
+// State of a tile while diffing one frame
+#define ESPIDF_TILE_UNCHECKED 0
+#define ESPIDF_TILE_SAME      1
+#define ESPIDF_TILE_CHANGED   2
+
+static Uint32 ESPIDF_HashTile(const SDL_Surface *surface, int tx, int ty)
+{
+    int x = tx * ESPIDF_TILE_SIZE;
+    int y = ty * ESPIDF_TILE_SIZE;
+    int w = SDL_min(ESPIDF_TILE_SIZE, surface->w - x);
+    int h = SDL_min(ESPIDF_TILE_SIZE, surface->h - y);
+    int bits = SDL_BITSPERPIXEL(surface->format);
+    // Bytes holding the tile's pixels, rounded out to whole bytes on 4-bit surfaces
+    int first = x * bits / 8;
+    int bytes = ((x + w) * bits + 7) / 8 - first;
+    const Uint8 *row = (const Uint8 *)surface->pixels + y * surface->pitch + first;
+    Uint32 hash = 0;
+
+    // Rows of a tile are not contiguous, chain them through the seed
+    for (int i = 0; i < h; i++) {
+        hash = SDL_murmur3_32(row, (size_t)bytes, hash);
+        row += surface->pitch;
+    }
+    return hash;
+}
+
+static SDL_Rect ESPIDF_TileSpan(const SDL_Surface *surface, int tx0, int tx1, int ty)
+{
+    SDL_Rect span;
+
+    span.x = tx0 * ESPIDF_TILE_SIZE;
+    span.y = ty * ESPIDF_TILE_SIZE;
+    span.w = SDL_min(tx1 * ESPIDF_TILE_SIZE, surface->w) - span.x;
+    span.h = SDL_min(ESPIDF_TILE_SIZE, surface->h - span.y);
+    return span;
+}
+
+#endif /* CONFIG_SDL_ESPIDF_TILE_DIFF */
+
+void ESPIDF_CreateTileDiff(ESPIDF_TileDiff *diff, int w, int h)
+{
+#ifdef CONFIG_SDL_ESPIDF_TILE_DIFF
+    ESPIDF_DestroyTileDiff(diff);
+    if (!SDL_GetHintBoolean(SDL_HINT_ESPIDF_TILE_DIFF, true)) {
+        return;
+    }
+
+    diff->tiles_x = (w + ESPIDF_TILE_SIZE - 1) / ESPIDF_TILE_SIZE;
+    diff->tiles_y = (h + ESPIDF_TILE_SIZE - 1) / ESPIDF_TILE_SIZE;
+    int tiles = diff->tiles_x * diff->tiles_y;
+
+    diff->hashes = heap_caps_malloc(tiles * sizeof(Uint32), MALLOC_CAP_8BIT);
+    diff->states = heap_caps_malloc(tiles, MALLOC_CAP_8BIT);
+    // At most every other tile of a row starts a span
+    diff->spans = heap_caps_malloc(diff->tiles_y * ((diff->tiles_x + 1) / 2) * sizeof(SDL_Rect), MALLOC_CAP_8BIT);
+    if (!diff->hashes || !diff->states || !diff->spans) {
+        // Diffing only saves bandwidth, presents still work without it
+        ESP_LOGW(TAG, "Not enough memory for %d tile hashes, tile diff disabled", tiles);
+        ESPIDF_DestroyTileDiff(diff);
+        return;
+    }
+
+    diff->valid = false;
+    ESP_LOGI(TAG, "Tile diff on %dx%d tiles of %d pixels", diff->tiles_x, diff->tiles_y, ESPIDF_TILE_SIZE);
+#endif
+}
+
+void ESPIDF_ResetTileDiff(ESPIDF_TileDiff *diff)
+{
+    diff->valid = false;
+}
+
+void ESPIDF_DestroyTileDiff(ESPIDF_TileDiff *diff)
+{
+    heap_caps_free(diff->hashes);
+    heap_caps_free(diff->states);
+    heap_caps_free(diff->spans);
+    diff->hashes = NULL;
+    diff->states = NULL;
+    diff->spans = NULL;
+    diff->valid = false;
+}
+
+int ESPIDF_DiffDirtyRects(ESPIDF_TileDiff *diff, const SDL_Surface *surface, const SDL_Rect *rects, int numrects, SDL_Rect *merged)
+{
+#ifdef CONFIG_SDL_ESPIDF_TILE_DIFF
+    SDL_Rect regions[ESPIDF_MAX_DIRTY_RECTS];
+    int count = ESPIDF_MergeDirtyRects(surface->w, surface->h, rects, numrects, regions);
+    int numspans = 0;
+
+    if (!diff->hashes) {
+        SDL_memcpy(merged, regions, count * sizeof(SDL_Rect));
+        return count;
+    }
+
+    // Hash every tile the reported regions touch, the whole frame when the app reports no dirty rects
+    SDL_memset(diff->states, ESPIDF_TILE_UNCHECKED, diff->tiles_x * diff->tiles_y);
+    for (int i = 0; i < count; i++) {
+        int tx0 = regions[i].x / ESPIDF_TILE_SIZE;
+        int ty0 = regions[i].y / ESPIDF_TILE_SIZE;
+        int tx1 = (regions[i].x + regions[i].w - 1) / ESPIDF_TILE_SIZE;
+        int ty1 = (regions[i].y + regions[i].h - 1) / ESPIDF_TILE_SIZE;
+
+        for (int ty = ty0; ty <= ty1; ty++) {
+            for (int tx = tx0; tx <= tx1; tx++) {
+                int tile = ty * diff->tiles_x + tx;
+                if (diff->states[tile] != ESPIDF_TILE_UNCHECKED) {
+                    continue;
+                }
+
+                Uint32 hash = ESPIDF_HashTile(surface, tx, ty);
+                if (diff->valid && hash == diff->hashes[tile]) {
+                    diff->states[tile] = ESPIDF_TILE_SAME;
+                    diff->skipped++;
+                } else {
+                    diff->hashes[tile] = hash;
+                    diff->states[tile] = ESPIDF_TILE_CHANGED;
+                    diff->sent++;
+                }
+            }
+        }
+    }
+    diff->valid = true;
+
+    // Coalesce changed tiles into horizontal spans, stacking spans that repeat on the next tile row
+    for (int ty = 0; ty < diff->tiles_y; ty++) {
+        int row_start = numspans;
+
+        for (int tx = 0; tx < diff->tiles_x; tx++) {
+            if (diff->states[ty * diff->tiles_x + tx] != ESPIDF_TILE_CHANGED) {
+                continue;
+            }
+
+            int tx0 = tx;
+            while (tx < diff->tiles_x && diff->states[ty * diff->tiles_x + tx] == ESPIDF_TILE_CHANGED) {
+                tx++;
+            }
+            SDL_Rect span = ESPIDF_TileSpan(surface, tx0, tx, ty);
+
+            int j;
+            for (j = 0; j < row_start; j++) {
+                if (diff->spans[j].x == span.x && diff->spans[j].w == span.w && diff->spans[j].y + diff->spans[j].h == span.y) {
+                    diff->spans[j].h += span.h;
+                    break;
+                }
+            }
+            if (j == row_start) {
+                diff->spans[numspans++] = span;
+            }
+        }
+    }
+
+    return ESPIDF_MergeDirtyRects(surface->w, surface->h, diff->spans, numspans, merged);
+#else
+    return ESPIDF_MergeDirtyRects(surface->w, surface->h, rects, numrects, merged);
+#endif
+}
+
+bool SDL_ESPIDF_GetTileDiffStats(SDL_Window *window, Uint64 *sent, Uint64 *skipped)
+{
+#ifdef CONFIG_SDL_ESPIDF_TILE_DIFF
+    if (!window || !window->internal) {
+        return SDL_InvalidParamError("window");
+    }
+    if (sent) {
+        *sent = window->internal->diff.sent;
+    }
+    if (skipped) {
+        *skipped = window->internal->diff.skipped;
+    }
+    return true;
+#else
+    return SDL_Unsupported();
+#endif
+}
+
+#endif /* SDL_VIDEO_DRIVER_PRIVATE */
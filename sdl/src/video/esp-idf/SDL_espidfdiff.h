@@ -0,0 +1,26 @@
+#ifndef SDL_espidfdiff_h_
+#define SDL_espidfdiff_h_
+
+#include "SDL_internal.h"
+
+// Tile hashes of one window
+typedef struct ESPIDF_TileDiff
+{
+    Uint32 *hashes;  // Hash of every tile as last sent to the panel, NULL while diffing is off
+    Uint8 *states;
+    SDL_Rect *spans;
+    int tiles_x;
+    int tiles_y;
+    bool valid;  // Nothing has been sent yet while false, every tile counts as changed
+    Uint64 sent;
+    Uint64 skipped;
+} ESPIDF_TileDiff;
+
+extern void ESPIDF_CreateTileDiff(ESPIDF_TileDiff *diff, int w, int h);
+extern void ESPIDF_DestroyTileDiff(ESPIDF_TileDiff *diff);
+// Count every tile as changed on the next present
+extern void ESPIDF_ResetTileDiff(ESPIDF_TileDiff *diff);
+// Like ESPIDF_MergeDirtyRects, but drops the tiles whose content matches the last flushed frame
+extern int ESPIDF_DiffDirtyRects(ESPIDF_TileDiff *diff, const SDL_Surface *surface, const SDL_Rect *rects, int numrects, SDL_Rect *merged);
+
+#endif /* SDL_espidfdiff_h_ */
@@ -0,0 +1,173 @@
+#include "SDL_internal.h"
+
+#ifdef SDL_VIDEO_DRIVER_PRIVATE
+
+#include "video/SDL_sysvideo.h"
+#include "SDL_espidfflip.h"
+#include "SDL_espidfshared.h"
+#include "SDL_espidfwindow.h"
+#include "SDL_espidfvsync.h"
+#include "SDL_espidfrotate.h"
+#include "SDL3/SDL_esp-idf.h"
+#include "esp_log.h"
+#include "esp_lcd_panel_ops.h"
+#ifdef CONFIG_IDF_TARGET_ESP32P4
+#include "esp_lcd_mipi_dsi.h"
+#elif defined(CONFIG_SOC_LCD_RGB_SUPPORTED)
+#include "esp_lcd_panel_rgb.h"
+#endif
+
+#ifdef CONFIG_SDL_ESPIDF_DIRECT_FRAMEBUFFER
+
+static const char *TAG = "SDL_espidfflip";
+
+#define ESPIDF_MAX_PANEL_FBS 3
+
+/*
+ * The window surface aliases one of the panel's own frame buffers. Presenting
+ * hands that buffer to the panel driver, which switches scan-out to it at the
+ * next refresh, and the surface moves on to the next buffer. The buffer that
+ * was on screen is only free once that refresh has started, which the panel
+ * callbacks report through ESPIDF_NotifyRefreshFromISR.
+ */
+static void *panel_fbs[ESPIDF_MAX_PANEL_FBS];
+static int panel_num_fbs = 0;  // 0 while the window is not backed by panel frame buffers
+static int back_fb = 0;
+static uint32_t flip_refresh = 0;  // Refresh that will show the last flipped buffer
+static bool flip_pending = false;
+
+#ifdef CONFIG_IDF_TARGET_ESP32P4
+static esp_err_t ESPIDF_GetPanelFrameBuffers(int num_fbs)
+{
+    return (num_fbs == 3) ? esp_lcd_dpi_panel_get_frame_buffer(ESPIDF_GetPrimaryPanel()->panel_handle, 3, &panel_fbs[0], &panel_fbs[1], &panel_fbs[2])
+                          : esp_lcd_dpi_panel_get_frame_buffer(ESPIDF_GetPrimaryPanel()->panel_handle, 2, &panel_fbs[0], &panel_fbs[1]);
+}
+#elif defined(CONFIG_SOC_LCD_RGB_SUPPORTED)
+static esp_err_t ESPIDF_GetPanelFrameBuffers(int num_fbs)
+{
+    return (num_fbs == 3) ? esp_lcd_rgb_panel_get_frame_buffer(ESPIDF_GetPrimaryPanel()->panel_handle, 3, &panel_fbs[0], &panel_fbs[1], &panel_fbs[2])
+                          : esp_lcd_rgb_panel_get_frame_buffer(ESPIDF_GetPrimaryPanel()->panel_handle, 2, &panel_fbs[0], &panel_fbs[1]);
+}
+#endif
+
+#endif /* CONFIG_SDL_ESPIDF_DIRECT_FRAMEBUFFER */
+
+SDL_Surface *ESPIDF_CreateFlipSurface(int w, int h)
+{
+#ifdef CONFIG_SDL_ESPIDF_DIRECT_FRAMEBUFFER
+    const SDL_DisplayData *panel = ESPIDF_GetPrimaryPanel();
+
+    if (panel->panel_interface == ESPIDF_PANEL_IO || !SDL_GetHintBoolean(SDL_HINT_ESPIDF_DIRECT_FRAMEBUFFER, true)) {
+        return NULL;
+    }
+    if (ESPIDF_GetRotation() != 0) {
+        ESP_LOGI(TAG, "Rotated display, copying through the rotation path instead");
+        return NULL;
+    }
+    if (w != panel->config.width || h != panel->config.height) {
+        ESP_LOGI(TAG, "Window %dx%d does not match the panel frame buffer, copying instead", w, h);
+        return NULL;
+    }
+
+    // The panel driver rejects counts above the num_fbs it was created with
+    panel_num_fbs = 0;
+    for (int num_fbs = ESPIDF_MAX_PANEL_FBS; num_fbs >= 2; num_fbs--) {
+        if (ESPIDF_GetPanelFrameBuffers(num_fbs) == ESP_OK) {
+            panel_num_fbs = num_fbs;
+            break;
+        }
+    }
+    if (panel_num_fbs == 0) {
+        ESP_LOGI(TAG, "Panel has a single frame buffer, set the BSP buffer count to 2 or 3 for page flipping");
+        return NULL;
+    }
+
+    // The panel starts out scanning the first buffer
+    back_fb = 1;
+    flip_pending = false;
+    SDL_Surface *surface = SDL_CreateSurfaceFrom(w, h, panel->config.pixel_format, panel_fbs[back_fb],
+                                                 w * SDL_BYTESPERPIXEL(panel->config.pixel_format));
+    if (!surface) {
+        ESPIDF_DestroyFlipPresent();
+        return NULL;
+    }
+
+    ESP_LOGI(TAG, "Window surface aliases %d panel frame buffers", panel_num_fbs);
+    return surface;
+#else
+    return NULL;
+#endif
+}
+
+bool ESPIDF_IsFlipPresent(const SDL_WindowData *data)
+{
+#ifdef CONFIG_SDL_ESPIDF_DIRECT_FRAMEBUFFER
+    // Only the window on the primary panel can alias its frame buffers
+    return panel_num_fbs > 0 && data->display->primary;
+#else
+    return false;
+#endif
+}
+
+void ESPIDF_WaitForFlip(void)
+{
+#ifdef CONFIG_SDL_ESPIDF_DIRECT_FRAMEBUFFER
+    if (!flip_pending) {
+        return;
+    }
+    ESPIDF_WaitForRefresh(flip_refresh);
+    flip_pending = false;
+#endif
+}
+
+bool ESPIDF_FlipIdle(void)
+{
+#ifdef CONFIG_SDL_ESPIDF_DIRECT_FRAMEBUFFER
+    return !flip_pending || (int32_t)(ESPIDF_GetRefreshCount() - flip_refresh) >= 0;
+#else
+    return true;
+#endif
+}
+
+void ESPIDF_FlipSurface(SDL_Window *window, SDL_Surface *surface)
+{
+#ifdef CONFIG_SDL_ESPIDF_DIRECT_FRAMEBUFFER
+    // Only one flip may be queued, the buffer it replaces stays on screen until it lands
+    ESPIDF_WaitForFlip();
+
+    // Drawing one of its own frame buffers makes the driver write back the cache and switch to it
+    ESP_ERROR_CHECK(esp_lcd_panel_draw_bitmap(ESPIDF_GetPrimaryPanel()->panel_handle, 0, 0, surface->w, surface->h, surface->pixels));
+
+    // The switch happens at the first refresh starting after the call, an earlier one only adds a frame
+    flip_refresh = ESPIDF_GetRefreshCount() + 1;
+    flip_pending = true;
+    back_fb = (back_fb + 1) % panel_num_fbs;
+
+    if (panel_num_fbs == 2) {
+        // With two buffers the new back buffer is the one on screen until the flip lands
+        ESPIDF_WaitForFlip();
+    }
+
+    // Hand the app its new back buffer, its content is the frame before the last one
+    surface->pixels = panel_fbs[back_fb];
+    if (window->surface) {
+        window->surface->pixels = panel_fbs[back_fb];
+    }
+#endif
+}
+
+void ESPIDF_DestroyFlipPresent(void)
+{
+#ifdef CONFIG_SDL_ESPIDF_DIRECT_FRAMEBUFFER
+    if (panel_num_fbs == 0) {
+        return;
+    }
+
+    ESPIDF_WaitForFlip();
+
+    // The frame buffers belong to the panel driver, the window surface only drops its alias
+    panel_num_fbs = 0;
+#endif
+}
+
+#endif /* SDL_VIDEO_DRIVER_PRIVATE */
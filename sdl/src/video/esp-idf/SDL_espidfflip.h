@@ -0,0 +1,14 @@
+#ifndef SDL_espidfflip_h_
+#define SDL_espidfflip_h_
+
+#include "SDL_internal.h"
+
+// Returns NULL without setting an error when the panel frame buffers cannot back the window
+extern SDL_Surface *ESPIDF_CreateFlipSurface(int w, int h);
+extern bool ESPIDF_IsFlipPresent(const SDL_WindowData *data);
+extern void ESPIDF_FlipSurface(SDL_Window *window, SDL_Surface *surface);
+extern void ESPIDF_WaitForFlip(void);
+extern bool ESPIDF_FlipIdle(void);
+extern void ESPIDF_DestroyFlipPresent(void);
+
+#endif /* SDL_espidfflip_h_ */
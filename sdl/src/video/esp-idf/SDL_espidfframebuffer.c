@@ -3,231 +3,1597 @@
 #ifdef SDL_VIDEO_DRIVER_PRIVATE
 
 #include "video/SDL_sysvideo.h"
-#include "SDL_properties_c.h"
 #include "SDL_espidfframebuffer.h"
+#include "SDL_espidfwindow.h"
+#include "SDL_espidfpresent.h"
+#include "SDL_espidfchunk.h"
+#include "SDL_espidfconvert.h"
+#include "SDL_espidfdiff.h"
+#include "SDL_espidfflip.h"
+#include "SDL_espidfbounce.h"
+#include "SDL_espidfvsync.h"
+#include "SDL_espidfrotate.h"
+#include "SDL_espidfscale.h"
+#include "SDL_espidfstats.h"
 #include "esp_err.h"
 #include "esp_check.h"
 #include "esp_lcd_panel_ops.h"
 #include "SDL_espidfshared.h"
+#include "SDL3/SDL_esp-idf.h"
 #include "esp_heap_caps.h"
+#include "esp_memory_utils.h"
+#include "esp_timer.h"
+#ifdef CONFIG_SDL_ESPIDF_ZERO_COPY
+#include "esp_cache.h"
+#endif
 #ifdef CONFIG_IDF_TARGET_ESP32P4
 #include "driver/ppa.h"
 #include "esp_lcd_types.h"
 #include "esp_lcd_mipi_dsi.h"
+#elif defined(CONFIG_SOC_LCD_RGB_SUPPORTED)
+#include "esp_lcd_panel_rgb.h"
 #endif
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
 
 static const char *TAG = "SDL_espidfframebuffer";
 
-#define ESPIDF_SURFACE "SDL.internal.window.surface"
+// Rows of zeros drawn at a time when clearing the letterbox bars
+#define ESPIDF_CLEAR_ROWS 16
+// Full-frame presents in a row after which automatic interlacing starts
+#define ESPIDF_INTERLACE_MOTION_FRAMES 4
+#ifdef CONFIG_SDL_ESPIDF_INTERLACE_AUTO
+#define ESPIDF_INTERLACE_DEFAULT "auto"
+#else
+#define ESPIDF_INTERLACE_DEFAULT "off"
+#endif
+
+// (Re)create the slot semaphore for depth chunks in flight, only while nothing is in flight
+static bool ESPIDF_SetRingDepth(SDL_WindowData *data, int depth)
+{
+    if (data->lcd_semaphore && depth == data->lcd_ring_depth) {
+        return true;
+    }
+    if (data->lcd_semaphore) {
+        ESPIDF_WaitForTransfers(data);
+        vSemaphoreDelete(data->lcd_semaphore);
+    }
+
+    data->lcd_ring_depth = depth;
+    data->lcd_semaphore = xSemaphoreCreateCounting(depth, depth);
+    if (!data->lcd_semaphore) {
+        return SDL_SetError("Failed to create semaphore");
+    }
+    return true;
+}
 
-static SemaphoreHandle_t lcd_semaphore;
-static int max_chunk_height = 4;  // Configurable chunk height
 #ifdef CONFIG_IDF_TARGET_ESP32P4
-static ppa_client_handle_t ppa_srm_handle = NULL;  // PPA client handle
-static uint8_t *ppa_out_buf = NULL;  // Reusable PPA output buffer
-static size_t ppa_out_buf_size = 0;  // Size of the PPA output buffer
+// Window formats the PPA turns into the panel format on the way to the panel
+static const SDL_PixelFormat ppa_window_formats[] = {
+    SDL_PIXELFORMAT_RGB565,
+    SDL_PIXELFORMAT_ARGB8888,
+    SDL_PIXELFORMAT_XRGB8888,
+    SDL_PIXELFORMAT_RGB24,
+    SDL_PIXELFORMAT_BGR24,
+};
+
+// Chunks go through the PPA whenever it has to scale, rotate, convert or byte swap them,
+// scaling and rotation only apply to the primary panel
+static bool ESPIDF_UsePPA(const SDL_WindowData *data)
+{
+    if (data->format != data->display->config.pixel_format || !data->display->cpu_byte_order) {
+        return true;
+    }
+    return ESPIDF_IsScaled(data) || (data->display->primary && ESPIDF_GetRotation() != 0);
+}
+
+// PPA input color mode for the window format, rgb_swap reorders RGB24 into the PPA's B,G,R byte order
+static ppa_srm_color_mode_t ESPIDF_PPAInputMode(SDL_PixelFormat format, bool *rgb_swap)
+{
+    *rgb_swap = false;
+    switch (format) {
+    case SDL_PIXELFORMAT_ARGB8888:
+    case SDL_PIXELFORMAT_XRGB8888:
+        return PPA_SRM_COLOR_MODE_ARGB8888;
+    case SDL_PIXELFORMAT_RGB24:
+        *rgb_swap = true;
+        return PPA_SRM_COLOR_MODE_RGB888;
+    case SDL_PIXELFORMAT_BGR24:
+        return PPA_SRM_COLOR_MODE_RGB888;
+    default:
+        return PPA_SRM_COLOR_MODE_RGB565;
+    }
+}
+
+// PPA output color mode for the panel, the PPA writes RGB888 in the B,G,R order the DSI bridge reads
+static ppa_srm_color_mode_t ESPIDF_PPAOutputMode(const SDL_DisplayData *display)
+{
+    return (ESPIDF_PanelBytesPerPixel(display) == 3) ? PPA_SRM_COLOR_MODE_RGB888 : PPA_SRM_COLOR_MODE_RGB565;
+}
+
+// PPA output per window row, rounded up to whole display rows
+static size_t ESPIDF_PPARowBytes(const SDL_WindowData *data, int w)
+{
+    return (size_t)((w * ESPIDF_GetScaleX16(data) + ESPIDF_SCALE_ONE - 1) / ESPIDF_SCALE_ONE) *
+           ((ESPIDF_GetScaleY16(data) + ESPIDF_SCALE_ONE - 1) / ESPIDF_SCALE_ONE) * ESPIDF_PanelBytesPerPixel(data->display);
+}
+
+// PPA rotates counter-clockwise, the display rotation is clockwise
+static ppa_srm_rotation_angle_t ESPIDF_PPARotation(const SDL_WindowData *data)
+{
+    switch (data->display->primary ? ESPIDF_GetRotation() : 0) {
+    case 90:
+        return PPA_SRM_ROTATION_ANGLE_270;
+    case 180:
+        return PPA_SRM_ROTATION_ANGLE_180;
+    case 270:
+        return PPA_SRM_ROTATION_ANGLE_90;
+    default:
+        return PPA_SRM_ROTATION_ANGLE_0;
+    }
+}
+
+static IRAM_ATTR bool ppa_trans_done_callback(ppa_client_handle_t ppa_client, ppa_event_data_t *event_data, void *user_data)
+{
+    SDL_WindowData *data = user_data;
+    BaseType_t need_yield = pdFALSE;
 
-#ifndef SCALE_FACTOR
-int scale_factor = 1;
-float scale_factor_float = 1.0;
-// Workaround to quickly pass scaling to PPA
-// This should be probably handled on Render level
-void set_scale_factor(int factor, float factor_float) {
-    scale_factor = factor;
-    scale_factor_float = factor_float;
+    // The PPA finishes transactions in submission order, the flush draws them in the same order
+    xSemaphoreGiveFromISR(data->ppa_done_semaphore, &need_yield);
+    return need_yield == pdTRUE;
+}
+
+static void ESPIDF_FreePPARing(SDL_WindowData *data)
+{
+    for (int i = 0; i < CONFIG_SDL_ESPIDF_DMA_RING_DEPTH; i++) {
+        heap_caps_free(data->ppa_out_ring[i]);
+        data->ppa_out_ring[i] = NULL;
+    }
+    data->ppa_out_buf_size = 0;
+}
+
+/*
+ * Pick the chunk height for the current scaling and allocate the PPA output
+ * ring for it. When one buffer can take the whole scaled window, each dirty
+ * region is a single PPA transaction and panel copy. Otherwise chunks are
+ * pipelined through the ring so scaling and panel copies overlap.
+ */
+static bool ESPIDF_ConfigurePPA(SDL_WindowData *data, int w, int h)
+{
+    ESPIDF_FreePPARing(data);
+
+    if (!ESPIDF_UsePPA(data)) {
+        // Unscaled chunks come straight from the surface, rows of different chunks never overlap
+        data->max_chunk_height = ESPIDF_SelectChunkHeight(data, w, h, 0);
+        return ESPIDF_SetRingDepth(data, CONFIG_SDL_ESPIDF_DMA_RING_DEPTH);
+    }
+
+    // Chunks must start on window rows that map to whole display rows
+    int align = ESPIDF_ScaleAlignmentY(data);
+    size_t row_bytes = ESPIDF_PPARowBytes(data, w);
+    int depth = 1;
+
+    data->max_chunk_height = ESPIDF_SelectChunkHeight(data, w, h, row_bytes);
+    if (data->max_chunk_height < h && CONFIG_SDL_ESPIDF_DMA_RING_DEPTH > 1) {
+        depth = CONFIG_SDL_ESPIDF_DMA_RING_DEPTH;
+        data->max_chunk_height = ESPIDF_SelectChunkHeight(data, w, h, row_bytes * depth);
+    }
+    data->max_chunk_height = SDL_min(SDL_max(data->max_chunk_height / align * align, align), h);
+
+    if (!ESPIDF_SetRingDepth(data, depth)) {
+        return false;
+    }
+
+    // The PPA writes back whole cache lines of its output
+    data->ppa_out_buf_size = (row_bytes * data->max_chunk_height + ESPIDF_SURFACE_ALIGN - 1) & ~(size_t)(ESPIDF_SURFACE_ALIGN - 1);
+    data->ppa_ring_next = 0;
+    for (int i = 0; i < depth; i++) {
+        data->ppa_out_ring[i] = heap_caps_aligned_alloc(ESPIDF_SURFACE_ALIGN, data->ppa_out_buf_size, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        if (!data->ppa_out_ring[i]) {
+            ESPIDF_FreePPARing(data);
+            return SDL_SetError("Failed to allocate PPA output buffer");
+        }
+    }
+
+    if (data->max_chunk_height == h) {
+        ESP_LOGI(TAG, "PPA scales the whole window in one transaction");
+    } else {
+        ESP_LOGI(TAG, "PPA pipelined over %d buffers of %d rows", depth, data->max_chunk_height);
+    }
+    return true;
+}
+
+#else
+#ifndef CONFIG_SDL_ESPIDF_ZERO_COPY
+// Window formats the flush expands into the RGB565 chunk ring through a LUT, 18/24-bit panels negotiate instead
+static const SDL_PixelFormat expand_window_formats[] = {
+    SDL_PIXELFORMAT_RGB565,
+    SDL_PIXELFORMAT_INDEX8,
+    SDL_PIXELFORMAT_RGB332,
+    SDL_PIXELFORMAT_INDEX4MSB,
+};
+
+// Whole factors the flush widens window pixels by, set on the primary panel by the logical presentation
+static int ESPIDF_ReplicateX(const SDL_WindowData *data)
+{
+    return ESPIDF_GetScaleX16(data) / ESPIDF_SCALE_ONE;
+}
+
+static int ESPIDF_ReplicateY(const SDL_WindowData *data)
+{
+    return ESPIDF_GetScaleY16(data) / ESPIDF_SCALE_ONE;
 }
 #endif
+#endif
+
+static IRAM_ATTR bool ESPIDF_TransferDoneFromISR(SDL_WindowData *data)
+{
+    BaseType_t need_yield = pdFALSE;
+
+    if (!data || !data->lcd_semaphore) {
+        // The panel shows no window framebuffer right now
+        return false;
+    }
+
+    // Release the chunk slot and let the flushing task run right away if it was waiting on it
+    xSemaphoreGiveFromISR(data->lcd_semaphore, &need_yield);
+    return need_yield == pdTRUE;
+}
+
+#ifdef CONFIG_IDF_TARGET_ESP32P4
+static IRAM_ATTR bool lcd_event_callback(esp_lcd_panel_handle_t panel_io, esp_lcd_dpi_panel_event_data_t *edata, void *user_ctx)
+{
+    return ESPIDF_TransferDoneFromISR(user_ctx);
+}
 
+static IRAM_ATTR bool lcd_refresh_callback(esp_lcd_panel_handle_t panel, esp_lcd_dpi_panel_event_data_t *edata, void *user_ctx)
+{
+    // A new frame starts scanning out, a pending page flip has landed
+    return ESPIDF_NotifyRefreshFromISR();
+}
 #else
-static uint16_t *rgb565_buffer = NULL;
+static IRAM_ATTR bool lcd_event_callback(esp_lcd_panel_io_handle_t io, esp_lcd_panel_io_event_data_t *event_data, void *user_ctx)
+{
+    return ESPIDF_TransferDoneFromISR(user_ctx);
+}
+
+#ifdef CONFIG_SOC_LCD_RGB_SUPPORTED
+static IRAM_ATTR bool lcd_rgb_event_callback(esp_lcd_panel_handle_t panel, const esp_lcd_rgb_panel_event_data_t *edata, void *user_ctx)
+{
+    return ESPIDF_TransferDoneFromISR(user_ctx);
+}
+
+static IRAM_ATTR bool lcd_rgb_vsync_callback(esp_lcd_panel_handle_t panel, const esp_lcd_rgb_panel_event_data_t *edata, void *user_ctx)
+{
+    return ESPIDF_NotifyRefreshFromISR();
+}
+
+static IRAM_ATTR bool lcd_rgb_bounce_callback(esp_lcd_panel_handle_t panel, void *bounce_buf, int pos_px, int len_bytes, void *user_ctx)
+{
+    return ESPIDF_FillBounceBufferFromISR(bounce_buf, pos_px, len_bytes);
+}
+#endif
 #endif
 
+// All panel events the driver listens to are hooked up here, registering again replaces earlier callbacks.
+// data is handed to the ISRs and NULL while the panel shows no window framebuffer.
+void ESPIDF_RegisterPanelCallbacks(SDL_DisplayData *display, SDL_WindowData *data)
+{
 #ifdef CONFIG_IDF_TARGET_ESP32P4
-static bool lcd_event_callback(esp_lcd_panel_handle_t panel_io, esp_lcd_dpi_panel_event_data_t *edata, void *user_ctx)
+    // Refreshes drive vsync and page flips, both belong to the primary panel
+    const esp_lcd_dpi_panel_event_callbacks_t callbacks = {
+        .on_color_trans_done = lcd_event_callback,
+        .on_refresh_done = display->primary ? lcd_refresh_callback : NULL,
+    };
+    esp_lcd_dpi_panel_register_event_callbacks(display->panel_handle, &callbacks, data);
+#else
+#ifdef CONFIG_SOC_LCD_RGB_SUPPORTED
+    if (display->panel_interface == ESPIDF_PANEL_RGB) {
+        // RGB panels copy into their frame buffer instead of running IO transactions
+        const esp_lcd_rgb_panel_event_callbacks_t callbacks = {
+            .on_color_trans_done = lcd_rgb_event_callback,
+            .on_vsync = display->primary ? lcd_rgb_vsync_callback : NULL,
+            .on_bounce_empty = ESPIDF_IsBouncePanel(display) ? lcd_rgb_bounce_callback : NULL,
+        };
+        esp_lcd_rgb_panel_register_event_callbacks(display->panel_handle, &callbacks, data);
+        return;
+    }
+#endif
+    esp_lcd_panel_io_register_event_callbacks(display->panel_io_handle, &(esp_lcd_panel_io_callbacks_t){ .on_color_trans_done = lcd_event_callback }, data);
+#endif
+}
+
+// Claim a chunk slot before queueing a transfer, the panel ISR releases it when done
+void ESPIDF_BeginTransfer(SDL_WindowData *data)
+{
+    ESPIDF_STATS_START(start);
+    xSemaphoreTake(data->lcd_semaphore, portMAX_DELAY);
+    ESPIDF_STATS_STAGE(data, ESPIDF_STAGE_WAIT, start);
+}
+
+// Block until every chunk in flight has been sent, the slots stay available afterwards
+void ESPIDF_WaitForTransfers(SDL_WindowData *data)
+{
+    ESPIDF_STATS_START(start);
+    if (data->display->primary) {
+        ESPIDF_WaitForFlip();
+    }
+    for (int i = 0; i < data->lcd_ring_depth; i++) {
+        xSemaphoreTake(data->lcd_semaphore, portMAX_DELAY);
+    }
+    for (int i = 0; i < data->lcd_ring_depth; i++) {
+        xSemaphoreGive(data->lcd_semaphore);
+    }
+    ESPIDF_STATS_STAGE(data, ESPIDF_STAGE_WAIT, start);
+}
+
+bool ESPIDF_TransfersIdle(const SDL_WindowData *data)
+{
+    return (!data->display->primary || ESPIDF_FlipIdle()) && (!data->lcd_semaphore || uxSemaphoreGetCount(data->lcd_semaphore) == (UBaseType_t)data->lcd_ring_depth);
+}
+
+static uint32_t ESPIDF_DefaultSurfaceCaps(void)
+{
+#if defined(CONFIG_SDL_ESPIDF_ZERO_COPY_PSRAM)
+    return MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT;
+#elif defined(CONFIG_SDL_ESPIDF_ZERO_COPY)
+    return MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL;
+#else
+    return MALLOC_CAP_8BIT;
+#endif
+}
+
+static bool ESPIDF_IsPowerOfTwo(Sint64 value)
+{
+    return value > 0 && (value & (value - 1)) == 0;
+}
+
+// Heap caps, alignment and row padding of the window surface, from the window properties or the hints
+static void ESPIDF_ConfigureSurfacePlacement(SDL_WindowData *data, SDL_Window *window)
+{
+    SDL_PropertiesID props = SDL_GetWindowProperties(window);
+    const char *memory = SDL_GetHint(SDL_HINT_ESPIDF_SURFACE_MEMORY);
+    const char *hint;
+    Sint64 value;
+
+    data->surface_caps = ESPIDF_DefaultSurfaceCaps();
+    if (!memory || SDL_strcasecmp(memory, "default") == 0) {
+        // Keep what the build configuration needs
+    } else if (SDL_strcasecmp(memory, "internal") == 0) {
+        data->surface_caps = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+    } else if (SDL_strcasecmp(memory, "psram") == 0) {
+        data->surface_caps = MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT;
+    } else if (SDL_strcasecmp(memory, "dma") == 0) {
+        data->surface_caps = MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+    } else {
+        ESP_LOGW(TAG, "Unknown window surface memory %s, using the default", memory);
+    }
+    data->surface_caps = (uint32_t)SDL_GetNumberProperty(props, SDL_PROP_WINDOW_CREATE_ESPIDF_SURFACE_CAPS_NUMBER, data->surface_caps);
+
+    hint = SDL_GetHint(SDL_HINT_ESPIDF_SURFACE_ALIGN);
+    value = SDL_GetNumberProperty(props, SDL_PROP_WINDOW_CREATE_ESPIDF_SURFACE_ALIGN_NUMBER, hint ? SDL_atoi(hint) : ESPIDF_SURFACE_ALIGN);
+    if (value < 4 || !ESPIDF_IsPowerOfTwo(value)) {
+        ESP_LOGW(TAG, "Window surface alignment %d is not a power of two of at least 4, using %d", (int)value, ESPIDF_SURFACE_ALIGN);
+        value = ESPIDF_SURFACE_ALIGN;
+    }
+    data->surface_align = (size_t)value;
+
+    hint = SDL_GetHint(SDL_HINT_ESPIDF_SURFACE_PITCH_ALIGN);
+    value = SDL_GetNumberProperty(props, SDL_PROP_WINDOW_CREATE_ESPIDF_SURFACE_PITCH_ALIGN_NUMBER, hint ? SDL_atoi(hint) : 0);
+    if (value != 0 && !ESPIDF_IsPowerOfTwo(value)) {
+        ESP_LOGW(TAG, "Window surface pitch alignment %d is not a power of two, using the default", (int)value);
+        value = 0;
+    }
+    data->surface_pitch_align = (int)value;
+
+    data->placed_pixels = NULL;
+    data->placed_size = 0;
+    data->placed_pitch = 0;
+}
+
+int ESPIDF_SurfacePitch(const SDL_WindowData *data, int w, SDL_PixelFormat format)
 {
-    xSemaphoreGive(lcd_semaphore);
-    return false;
+    int align = data->surface_pitch_align;
+    int row_bytes = (w * SDL_BITSPERPIXEL(format) + 7) / 8;
+
+    if (align == 0) {
+#ifdef CONFIG_SDL_ESPIDF_ZERO_COPY
+        // Unpadded, so a range of rows is one contiguous DMA transfer
+        align = 1;
+#else
+        // Same 4-byte aligned pitch SDL_CreateSurface would pick
+        align = 4;
+#endif
+    }
+    return (row_bytes + align - 1) & ~(align - 1);
+}
+
+#ifdef CONFIG_SDL_ESPIDF_ZERO_COPY
+// Zero-copy surfaces are read by the panel DMA, which only reaches PSRAM through the ESP32-S3 EDMA
+static bool ESPIDF_PanelCanRead(const void *pixels)
+{
+#ifdef CONFIG_IDF_TARGET_ESP32S3
+    if (esp_ptr_external_ram(pixels)) {
+        return true;
+    }
+#endif
+    return esp_ptr_dma_capable(pixels);
+}
+#endif
+
+void *ESPIDF_AllocSurfacePixels(SDL_WindowData *data, size_t size)
+{
+    void *pixels = heap_caps_aligned_calloc(data->surface_align, 1, size, data->surface_caps);
+
+    if (!pixels && data->surface_caps != MALLOC_CAP_8BIT) {
+        ESP_LOGW(TAG, "No %u bytes with heap caps 0x%x for the window surface, placing it anywhere",
+                 (unsigned)size, (unsigned)data->surface_caps);
+        pixels = heap_caps_aligned_calloc(data->surface_align, 1, size, MALLOC_CAP_8BIT);
+    }
+#ifdef CONFIG_SDL_ESPIDF_ZERO_COPY
+    if (pixels && !ESPIDF_PanelCanRead(pixels)) {
+        // The panel reads zero-copy surfaces itself, so move the surface where its DMA reaches
+        ESP_LOGW(TAG, "The panel cannot read the window surface at %p, moving it to internal DMA memory", pixels);
+        heap_caps_free(pixels);
+        pixels = heap_caps_aligned_calloc(data->surface_align, 1, size, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        if (!pixels) {
+            SDL_SetError("No DMA-capable memory for the zero-copy window surface, turn off CONFIG_SDL_ESPIDF_ZERO_COPY to copy it to the panel instead");
+            return NULL;
+        }
+    }
+#endif
+    if (pixels && !data->placed_pixels) {
+        data->placed_pixels = pixels;
+        data->placed_size = size;
+    }
+    return pixels;
 }
+
+// The panel format when a w x h surface of it fits in memory with the given heap caps, RGB565 converted by the flush otherwise
+static SDL_PixelFormat ESPIDF_NegotiateFormat(const SDL_DisplayData *display, uint32_t caps, int w, int h)
+{
+    SDL_PixelFormat native = display->config.pixel_format;
+
+    if (ESPIDF_PanelBytesPerPixel(display) != 3) {
+        return SDL_PIXELFORMAT_RGB565;
+    }
+#ifdef CONFIG_SDL_ESPIDF_ZERO_COPY
+    // The panel reads the surface as it is
+    return native;
 #else
-static bool lcd_event_callback(esp_lcd_panel_io_handle_t io, esp_lcd_panel_io_event_data_t *event_data, void *user_ctx)
+    size_t size = (size_t)w * h * SDL_BYTESPERPIXEL(native);
+
+    if (heap_caps_get_largest_free_block(caps) >= size) {
+        return native;
+    }
+    ESP_LOGI(TAG, "No %u bytes for a %s window surface, RGB565 is expanded while flushing", (unsigned)size, SDL_GetPixelFormatName(native));
+    return SDL_PIXELFORMAT_RGB565;
+#endif
+}
+
+SDL_PixelFormat ESPIDF_NegotiatePanelFormat(const SDL_DisplayData *display, int w, int h)
 {
-    xSemaphoreGive(lcd_semaphore);
-    return false;
+    return ESPIDF_NegotiateFormat(display, ESPIDF_DefaultSurfaceCaps(), w, h);
 }
+
+// Window surface format, other formats than RGB565 are only offered where the PPA or the flush converts them.
+// 18/24-bit panels get their own format or RGB565, whichever ESPIDF_NegotiateFormat picks, unless the hint names one.
+static SDL_PixelFormat ESPIDF_SelectWindowFormat(const SDL_WindowData *data, int w, int h)
+{
+    const SDL_DisplayData *display = data->display;
+    const char *name = SDL_GetHint(SDL_HINT_ESPIDF_WINDOW_FORMAT);
+
+#if defined(CONFIG_IDF_TARGET_ESP32P4)
+    const SDL_PixelFormat *formats = ppa_window_formats;
+    size_t num_formats = SDL_arraysize(ppa_window_formats);
+
+    if (!display->primary) {
+        // Further panels are copied straight from the surface
+        return display->config.pixel_format;
+    }
+#elif !defined(CONFIG_SDL_ESPIDF_ZERO_COPY)
+    const SDL_PixelFormat *formats = expand_window_formats;
+    size_t num_formats = SDL_arraysize(expand_window_formats);
+    const SDL_PixelFormat formats_24[] = { display->config.pixel_format, SDL_PIXELFORMAT_RGB565 };
+
+    if (ESPIDF_PanelBytesPerPixel(display) == 3) {
+        // The lookup tables hold RGB565 colors, 18/24-bit panels take their own format or expanded RGB565
+        formats = formats_24;
+        num_formats = SDL_arraysize(formats_24);
+    }
 #endif
 
-void esp_idf_log_free_dma(void) {
-    size_t free_dma = heap_caps_get_free_size(MALLOC_CAP_DMA);
-    ESP_LOGI(TAG, "Free DMA memory: %d bytes", free_dma);
+    if (!name && ESPIDF_PanelBytesPerPixel(display) == 3) {
+        return ESPIDF_NegotiateFormat(display, data->surface_caps, w, h);
+    }
+
+#ifdef CONFIG_SDL_ESPIDF_ZERO_COPY
+    // The panel reads the surface as it is
+    return display->config.pixel_format;
+#else
+    if (!name) {
+        name = CONFIG_SDL_ESPIDF_WINDOW_FORMAT;
+    }
+
+    for (size_t i = 0; i < num_formats; i++) {
+        // Both "SDL_PIXELFORMAT_XRGB8888" and "XRGB8888" are accepted
+        const char *format_name = SDL_GetPixelFormatName(formats[i]);
+        if (SDL_strcasecmp(name, format_name) == 0 || SDL_strcasecmp(name, format_name + SDL_strlen("SDL_PIXELFORMAT_")) == 0) {
+            return formats[i];
+        }
+    }
+    ESP_LOGW(TAG, "Unsupported window format %s, negotiating one with the panel", name);
+    return ESPIDF_NegotiateFormat(display, data->surface_caps, w, h);
+#endif
 }
 
-bool SDL_ESPIDF_CreateWindowFramebuffer(SDL_VideoDevice *_this, SDL_Window *window, SDL_PixelFormat *format, void **pixels, int *pitch)
+// True when the panel reads chunks straight from the surface, which then must not change until they are sent
+static bool ESPIDF_ScanOutFromSurface(const SDL_WindowData *data, const SDL_Surface *surface)
+{
+#if defined(CONFIG_IDF_TARGET_ESP32P4)
+    return !ESPIDF_UsePPA(data);
+#elif defined(CONFIG_SDL_ESPIDF_ZERO_COPY)
+    return true;
+#else
+    // Nothing left to convert or widen, a surface the DMA can read needs no copy either
+    return data->display->cpu_byte_order && surface->format == SDL_PIXELFORMAT_RGB565 && esp_ptr_dma_capable(surface->pixels) &&
+           ESPIDF_ReplicateX(data) == 1 && ESPIDF_ReplicateY(data) == 1;
+#endif
+}
+
+static SDL_Surface *ESPIDF_CreateSyncSurface(SDL_WindowData *data, int w, int h, SDL_PixelFormat format)
 {
+    int pitch = ESPIDF_SurfacePitch(data, w, format);
     SDL_Surface *surface;
-    int w, h;
 
-    SDL_GetWindowSizeInPixels(window, &w, &h);
-    surface = SDL_CreateSurface(w, h, SDL_PIXELFORMAT_RGB565);
+    data->surface_pixels = ESPIDF_AllocSurfacePixels(data, (size_t)pitch * h);
+    if (!data->surface_pixels) {
+        SDL_SetError("Failed to allocate window surface");
+        return NULL;
+    }
+
+    surface = SDL_CreateSurfaceFrom(w, h, format, data->surface_pixels, pitch);
     if (!surface) {
+        heap_caps_free(data->surface_pixels);
+        data->surface_pixels = NULL;
+    }
+    return surface;
+}
+
+void esp_idf_log_free_dma(const SDL_WindowData *data) {
+    size_t free_dma = heap_caps_get_free_size(MALLOC_CAP_DMA);
+    ESP_LOGI(TAG, "Free DMA memory: %u bytes", (unsigned)free_dma);
+
+    if (data && data->placed_pixels) {
+        ESP_LOGI(TAG, "Window surface: %u bytes at %p in %s%s, %u-byte aligned, pitch %d",
+                 (unsigned)data->placed_size, data->placed_pixels,
+                 esp_ptr_external_ram(data->placed_pixels) ? "PSRAM" : "internal RAM",
+                 esp_ptr_dma_capable(data->placed_pixels) ? " (DMA-capable)" : "",
+                 (unsigned)data->surface_align, data->placed_pitch);
+    }
+}
+
+static bool ESPIDF_ShouldMergeRects(const SDL_Rect *a, const SDL_Rect *b)
+{
+    SDL_Rect u;
+
+    if (SDL_HasRectIntersection(a, b)) {
+        return true;
+    }
+
+    // Neighbours are merged only when the union does not drag in extra pixels
+    SDL_GetRectUnion(a, b, &u);
+    return (Sint64)u.w * u.h <= (Sint64)a->w * a->h + (Sint64)b->w * b->h;
+}
+
+// Clip the rects to a w x h surface and merge them into at most ESPIDF_MAX_DIRTY_RECTS regions
+int ESPIDF_MergeDirtyRects(int w, int h, const SDL_Rect *rects, int numrects, SDL_Rect *merged)
+{
+    const SDL_Rect bounds = { 0, 0, w, h };
+    int count = 0;
+
+    for (int i = 0; i < numrects; i++) {
+        SDL_Rect rect;
+        if (!SDL_GetRectIntersection(&rects[i], &bounds, &rect)) {
+            continue;
+        }
+
+        // Absorb every region the new rect touches, rescanning since the union grew
+        for (int j = 0; j < count;) {
+            if (ESPIDF_ShouldMergeRects(&rect, &merged[j])) {
+                SDL_GetRectUnion(&rect, &merged[j], &rect);
+                merged[j] = merged[--count];
+                j = 0;
+            } else {
+                j++;
+            }
+        }
+
+        if (count == ESPIDF_MAX_DIRTY_RECTS) {
+            // Out of slots: grow the region whose union adds the fewest pixels
+            int best = 0;
+            Sint64 best_cost = -1;
+            for (int j = 0; j < count; j++) {
+                SDL_Rect u;
+                SDL_GetRectUnion(&rect, &merged[j], &u);
+                Sint64 cost = (Sint64)u.w * u.h - (Sint64)merged[j].w * merged[j].h;
+                if (best_cost < 0 || cost < best_cost) {
+                    best = j;
+                    best_cost = cost;
+                }
+            }
+            SDL_GetRectUnion(&rect, &merged[best], &merged[best]);
+            continue;
+        }
+
+        merged[count++] = rect;
+    }
+
+    return count;
+}
+
+#if !defined(CONFIG_IDF_TARGET_ESP32P4) && !defined(CONFIG_SDL_ESPIDF_ZERO_COPY)
+static void ESPIDF_FreeChunkRing(SDL_WindowData *data)
+{
+    for (int i = 0; i < CONFIG_SDL_ESPIDF_DMA_RING_DEPTH; i++) {
+        heap_caps_free(data->chunk_ring[i]);
+        data->chunk_ring[i] = NULL;
+    }
+}
+
+// Conversion kernels, chunk height and chunk ring for a w x h surface at the current scale
+static bool ESPIDF_ConfigureChunkRing(SDL_WindowData *data, int w, int h)
+{
+    SDL_DisplayData *display = data->display;
+    // A chunk holds the display rows its window rows are widened to
+    size_t row_bytes = (size_t)w * ESPIDF_ReplicateX(data) * ESPIDF_ReplicateY(data) * ESPIDF_PanelBytesPerPixel(display);
+
+    ESPIDF_FreeChunkRing(data);
+
+    // Transfers can be timed from here on, so the chunk height may be calibrated
+    data->max_chunk_height = ESPIDF_SelectChunkHeight(data, w, h, row_bytes * data->lcd_ring_depth);
+
+    if (ESPIDF_PanelBytesPerPixel(display) == 3) {
+        data->convert_24 = ESPIDF_SelectConvert24Kernel(data->format, display->config.pixel_format);
+        data->expand_pixels = NULL;
+    } else {
+        data->convert_24 = NULL;
+        data->convert_rgb565 = ESPIDF_SelectConvertKernel(!display->cpu_byte_order);
+        data->expand_pixels = ESPIDF_SelectExpandKernel(&data->expand_lut, data->format, !display->cpu_byte_order);
+    }
+
+    // Allocate the chunk ring in internal DMA-capable RAM, 16-byte aligned for the vector kernel
+    data->chunk_ring_next = 0;
+    for (int i = 0; i < data->lcd_ring_depth; i++) {
+        data->chunk_ring[i] = heap_caps_aligned_alloc(16, row_bytes * data->max_chunk_height, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        if (!data->chunk_ring[i]) {
+            ESPIDF_FreeChunkRing(data);
+            return SDL_SetError("Failed to allocate memory for the chunk ring");
+        }
+    }
+    return true;
+}
+#endif
+
+// Draw black over display areas, on the primary panel they are given on the rotated display
+static void ESPIDF_ClearPanelRects(SDL_WindowData *data, const SDL_Rect *rects, int count)
+{
+    int dw = data->display->config.width;
+    int dh = data->display->config.height;
+    uint8_t *zeros = NULL;
+
+    if (ESPIDF_IsBouncePanel(data->display)) {
+        // The panel ISR fills everything outside the window black by itself
+        return;
+    }
+    if (data->display->primary) {
+        ESPIDF_GetRotatedSize(&dw, &dh);
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (rects[i].w <= 0 || rects[i].h <= 0) {
+            continue;
+        }
+        if (!zeros) {
+            zeros = heap_caps_calloc((size_t)SDL_max(dw, dh) * ESPIDF_CLEAR_ROWS, ESPIDF_PanelBytesPerPixel(data->display), MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+            if (!zeros) {
+                ESP_LOGW(TAG, "Not enough memory to clear the panel around the window");
+                return;
+            }
+        }
+
+#ifdef CONFIG_IDF_TARGET_ESP32P4
+        SDL_Rect bar = data->display->primary ? ESPIDF_RotateRect(&rects[i], dw, dh) : rects[i];
+#else
+        // The panel turns by itself
+        SDL_Rect bar = rects[i];
+#endif
+        for (int y = bar.y; y < bar.y + bar.h; y += ESPIDF_CLEAR_ROWS) {
+            ESPIDF_BeginTransfer(data);
+            ESP_ERROR_CHECK(esp_lcd_panel_draw_bitmap(data->display->panel_handle, bar.x, y, bar.x + bar.w,
+                                                      SDL_min(y + ESPIDF_CLEAR_ROWS, bar.y + bar.h), zeros));
+        }
+    }
+
+    if (zeros) {
+        ESPIDF_WaitForTransfers(data);
+        heap_caps_free(zeros);
+    }
+}
+
+SDL_Rect ESPIDF_GetPanelRect(const SDL_WindowData *data)
+{
+    if (data->display->primary) {
+        return ESPIDF_GetPresentationRect(data);
+    }
+    // Bands cover the whole window over a frame, not just the rows of one band
+    return (SDL_Rect){ data->x, data->y, data->surface->w, data->band_h ? data->band_h : data->surface->h };
+}
+
+// Black out the parts of the panel the window does not cover
+static void ESPIDF_ClearAroundWindow(SDL_WindowData *data)
+{
+    SDL_Rect r = ESPIDF_GetPanelRect(data);
+    int dw = data->display->config.width;
+    int dh = data->display->config.height;
+
+    if (data->display->primary) {
+        ESPIDF_GetRotatedSize(&dw, &dh);
+    }
+    const SDL_Rect bars[4] = {
+        { 0, 0, dw, r.y },
+        { 0, r.y + r.h, dw, dh - (r.y + r.h) },
+        { 0, r.y, r.x, r.h },
+        { r.x + r.w, r.y, dw - (r.x + r.w), r.h },
+    };
+    ESPIDF_ClearPanelRects(data, bars, SDL_arraysize(bars));
+}
+
+// Clear what the window covered at old and no longer covers at cur
+static void ESPIDF_ClearVacated(SDL_WindowData *data, const SDL_Rect *old, const SDL_Rect *cur)
+{
+    SDL_Rect inter;
+
+    if (!SDL_GetRectIntersection(old, cur, &inter)) {
+        ESPIDF_ClearPanelRects(data, old, 1);
+        return;
+    }
+    const SDL_Rect bars[4] = {
+        { old->x, old->y, old->w, inter.y - old->y },
+        { old->x, inter.y + inter.h, old->w, old->y + old->h - (inter.y + inter.h) },
+        { old->x, inter.y, inter.x - old->x, inter.h },
+        { inter.x + inter.w, inter.y, old->x + old->w - (inter.x + inter.w), inter.h },
+    };
+    ESPIDF_ClearPanelRects(data, bars, SDL_arraysize(bars));
+}
+
+// Panel position of a w x h window, from the window position on its display and kept on the panel
+static void ESPIDF_PlaceWindow(SDL_Window *window, int w, int h)
+{
+    SDL_WindowData *data = window->internal;
+    SDL_Rect bounds = { 0, 0, 0, 0 };
+    int pw = data->display->config.width;
+    int ph = data->display->config.height;
+
+    if (data->display->primary) {
+        ESPIDF_GetRotatedSize(&pw, &ph);
+    }
+    // Window positions are global, every display starts at its own bounds
+    SDL_GetDisplayBounds(SDL_GetDisplayForWindow(window), &bounds);
+    data->x = SDL_clamp(window->x - bounds.x, 0, SDL_max(pw - w, 0));
+    data->y = SDL_clamp(window->y - bounds.y, 0, SDL_max(ph - h, 0));
+}
+
+#if defined(CONFIG_IDF_TARGET_ESP32P4) || !defined(CONFIG_SDL_ESPIDF_ZERO_COPY)
+// The logical presentation mode changed for the same window size, nothing may be in flight meanwhile
+static bool ESPIDF_ReconfigurePresentation(SDL_Window *window, SDL_Surface *surface)
+{
+    SDL_WindowData *data = window->internal;
+
+    SDL_ESPIDF_WaitForFrame(window, SDL_ESPIDF_GetLastSubmittedFrame(window), -1);
+    ESPIDF_WaitForTransfers(data);
+
+#ifdef CONFIG_IDF_TARGET_ESP32P4
+    if (!ESPIDF_ConfigurePPA(data, surface->w, surface->h)) {
+        return false;
+    }
+#else
+    if (!ESPIDF_ConfigureChunkRing(data, surface->w, surface->h)) {
         return false;
     }
+#endif
+    ESPIDF_ClearAroundWindow(data);
+    // The panel content changed behind the tile hashes
+    ESPIDF_CreateTileDiff(&data->diff, surface->w, surface->h);
+    return true;
+}
+#endif
 
-    SDL_SetSurfaceProperty(SDL_GetWindowProperties(window), ESPIDF_SURFACE, surface);
-    *format = SDL_PIXELFORMAT_RGB565;
-    *pixels = surface->pixels;
-    *pitch = surface->pitch;
+// Keeps the window's interlace mode in step with SDL_HINT_ESPIDF_INTERLACE
+static void SDLCALL ESPIDF_InterlaceHintChanged(void *userdata, const char *name, const char *oldValue, const char *newValue)
+{
+    SDL_WindowData *data = userdata;
+    const char *mode = newValue ? newValue : ESPIDF_INTERLACE_DEFAULT;
 
-#ifndef CONFIG_IDF_TARGET_ESP32P4
-    // Allocate RGB565 buffer in IRAM
-    rgb565_buffer = heap_caps_malloc(w * max_chunk_height * sizeof(uint16_t), MALLOC_CAP_32BIT | MALLOC_CAP_INTERNAL);
-    if (!rgb565_buffer) {
-        SDL_DestroySurface(surface);
-        return SDL_SetError("Failed to allocate memory for RGB565 buffer");
+    if (SDL_strcasecmp(mode, "on") == 0) {
+        data->interlace = ESPIDF_INTERLACE_ON;
+    } else if (SDL_strcasecmp(mode, "auto") == 0) {
+        data->interlace = ESPIDF_INTERLACE_AUTO;
+    } else {
+        data->interlace = ESPIDF_INTERLACE_OFF;
     }
+}
+
+// Ring, panel callbacks, PPA and chunk height for a w x h surface, the caller tears down on failure
+static bool ESPIDF_SetupFlush(SDL_Window *window, int w, int h)
+{
+    SDL_WindowData *data = window->internal;
+    SDL_DisplayData *display = data->display;
+
+#ifdef CONFIG_SDL_ESPIDF_PRESENT_STATS
+    ESPIDF_ResetPresentStats(&data->stats, SDL_GetWindowProperties(window));
 #endif
 
-    // Create a semaphore to synchronize LCD transactions
-    lcd_semaphore = xSemaphoreCreateBinary();
-    if (!lcd_semaphore) {
-        SDL_DestroySurface(surface);
-        return SDL_SetError("Failed to create semaphore");
+    // A new surface starts out progressive, SDL calls the hint callback with the current mode right away
+    data->motion_frames = 0;
+    data->field_pending = (SDL_Rect){ 0, 0, 0, 0 };
+    SDL_AddHintCallback(SDL_HINT_ESPIDF_INTERLACE, ESPIDF_InterlaceHintChanged, data);
+
+    const char *hint = SDL_GetHint(SDL_HINT_ESPIDF_DIRTY_RECT_FULL_FRAME_PERCENT);
+    data->full_frame_percent = hint ? SDL_clamp(SDL_atoi(hint), 0, 100) : CONFIG_SDL_ESPIDF_DIRTY_RECT_FULL_FRAME_PERCENT;
+
+    // Counting semaphore of free chunk slots, the P4 adjusts it once it knows whether the PPA is needed
+    if (!ESPIDF_SetRingDepth(data, CONFIG_SDL_ESPIDF_DMA_RING_DEPTH)) {
+        return false;
+    }
+
+    ESPIDF_RegisterPanelCallbacks(display, data);
+    if (display->primary) {
+        ESPIDF_StartRefreshSource();
     }
 
     // Initialize PPA (only for ESP32-P4)
 #ifdef CONFIG_IDF_TARGET_ESP32P4
-    if (!ppa_srm_handle) {
+    if (!data->ppa_srm_handle) {
         ppa_client_config_t ppa_srm_config = {
             .oper_type = PPA_OPERATION_SRM,
-            .max_pending_trans_num = 1,
+            .max_pending_trans_num = CONFIG_SDL_ESPIDF_DMA_RING_DEPTH,
         };
-        ESP_ERROR_CHECK(ppa_register_client(&ppa_srm_config, &ppa_srm_handle));
+        data->ppa_done_semaphore = xSemaphoreCreateCounting(CONFIG_SDL_ESPIDF_DMA_RING_DEPTH, 0);
+        if (!data->ppa_done_semaphore) {
+            return SDL_SetError("Failed to create semaphore");
+        }
+        ESP_ERROR_CHECK(ppa_register_client(&ppa_srm_config, &data->ppa_srm_handle));
+        ESP_ERROR_CHECK(ppa_client_register_event_callbacks(data->ppa_srm_handle, &(ppa_event_callbacks_t){ .on_trans_done = ppa_trans_done_callback }));
     }
+#endif
 
-    if (scale_factor != 1) {
-        // Allocate reusable PPA output buffer
-        ppa_out_buf_size = (w * scale_factor) * (max_chunk_height * scale_factor) * sizeof(uint16_t);  // 2x scaling
-        ppa_out_buf = heap_caps_malloc(ppa_out_buf_size, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
-        if (!ppa_out_buf) {
-            return SDL_SetError("Failed to allocate PPA output buffer");
-        }
+    if (ESPIDF_IsFlipPresent(data) || ESPIDF_IsBouncePresent(data)) {
+        // Nothing is copied, so no chunk buffers are needed
+        return true;
     }
-    const esp_lcd_dpi_panel_event_callbacks_t callback = {
-        .on_color_trans_done = lcd_event_callback,
-    };
-    esp_lcd_dpi_panel_register_event_callbacks(panel_handle, &callback, NULL);
+
+#if defined(CONFIG_IDF_TARGET_ESP32P4)
+    if (!ESPIDF_ConfigurePPA(data, w, h)) {
+        return false;
+    }
+#elif defined(CONFIG_SDL_ESPIDF_ZERO_COPY)
+    // Chunks are sent from the surface itself, transfers can be timed from here on
+    data->max_chunk_height = ESPIDF_SelectChunkHeight(data, w, h, 0);
 #else
-    esp_lcd_panel_io_register_event_callbacks(panel_io_handle, &(esp_lcd_panel_io_callbacks_t){ .on_color_trans_done = lcd_event_callback }, NULL);
+    if (!ESPIDF_ConfigureChunkRing(data, w, h)) {
+        return false;
+    }
 #endif
 
+    // Leftovers of earlier windows or of this one at another size or place
+    ESPIDF_ClearAroundWindow(data);
     return true;
 }
 
-IRAM_ATTR bool SDL_ESPIDF_UpdateWindowFramebuffer(SDL_VideoDevice *_this, SDL_Window *window, const SDL_Rect *rects, int numrects)
+// 18/24-bit panels report the negotiated window format as their display mode, it depends on the memory left
+static void ESPIDF_ReportWindowFormat(SDL_Window *window)
+{
+    SDL_WindowData *data = window->internal;
+    SDL_VideoDisplay *display = SDL_GetVideoDisplayForWindow(window);
+
+    if (ESPIDF_PanelBytesPerPixel(data->display) != 3 || !display || display->internal != data->display ||
+        display->desktop_mode.format == data->format) {
+        return;
+    }
+
+    SDL_DisplayMode mode = display->desktop_mode;
+    mode.format = data->format;
+    SDL_SetDesktopDisplayMode(display, &mode);
+    SDL_SetCurrentDisplayMode(display, &mode);
+}
+
+// Panels show one window, which renders either through its framebuffer or in bands
+static bool ESPIDF_ClaimPanel(SDL_Window *window)
+{
+    SDL_WindowData *data = window->internal;
+
+    if (data->band_renderer) {
+        return SDL_SetError("Window renders in bands, it has no framebuffer");
+    }
+    if (data->display->window && data->display->window != window) {
+        return SDL_SetError("Panel already shows another window");
+    }
+    return true;
+}
+
+void ESPIDF_MoveWindowFramebuffer(SDL_Window *window)
+{
+    SDL_WindowData *data = window->internal;
+
+    if (!data || !data->surface) {
+        // Placed when the framebuffer is created
+        return;
+    }
+
+    int w = data->surface->w;
+    int h = data->band_h ? data->band_h : data->surface->h;
+    SDL_Rect old = ESPIDF_GetPanelRect(data);
+
+    // Nothing may still be on its way to the old place
+    SDL_ESPIDF_WaitForFrame(window, SDL_ESPIDF_GetLastSubmittedFrame(window), -1);
+    ESPIDF_WaitForTransfers(data);
+
+    ESPIDF_PlaceWindow(window, w, h);
+    if (data->display->primary) {
+        ESPIDF_UpdatePresentation(window, w, h);
+    }
+    SDL_Rect cur = ESPIDF_GetPanelRect(data);
+    if (cur.x == old.x && cur.y == old.y) {
+        return;
+    }
+
+    ESPIDF_ClearVacated(data, &old, &cur);
+    // The panel no longer shows what the tile hashes remember
+    ESPIDF_ResetTileDiff(&data->diff);
+    data->moved = true;
+}
+
+bool SDL_ESPIDF_CreateWindowFramebuffer(SDL_VideoDevice *_this, SDL_Window *window, SDL_PixelFormat *format, void **pixels, int *pitch)
 {
-    SDL_Surface *surface = (SDL_Surface *)SDL_GetPointerProperty(SDL_GetWindowProperties(window), ESPIDF_SURFACE, NULL);
+    SDL_WindowData *data = window->internal;
+    SDL_DisplayData *display = data->display;
+    SDL_Surface *surface = NULL;
+    int w, h;
+
+    if (!ESPIDF_ClaimPanel(window)) {
+        return false;
+    }
+    if (data->surface) {
+        // Recreated at a new size, the old surface and chunk buffers go first
+        SDL_ESPIDF_DestroyWindowFramebuffer(_this, window);
+    }
+
+    SDL_GetWindowSizeInPixels(window, &w, &h);
+
+    ESPIDF_ConfigureSurfacePlacement(data, window);
+    data->format = ESPIDF_SelectWindowFormat(data, w, h);
+#ifdef CONFIG_IDF_TARGET_ESP32P4
+    if (SDL_BYTESPERPIXEL(data->format) == 3 && ESPIDF_SurfacePitch(data, w, data->format) % 3 != 0) {
+        // The PPA needs a whole number of pixels per row, padded 24-bit rows are not
+        ESP_LOGW(TAG, "Window width %d pads 24-bit rows, using XRGB8888", w);
+        data->format = SDL_PIXELFORMAT_XRGB8888;
+    }
+#endif
+
+    // Aliasing the panel's own frame buffers beats any copy, the other modes are fallbacks.
+    // Page flips and the flush task only serve the primary panel.
+    if (ESPIDF_IsBouncePanel(display)) {
+        // Without a frame buffer there is nothing to copy into, the panel ISR reads the surface itself
+        surface = ESPIDF_CreateBounceSurface(data, w, h, data->format);
+        if (!surface) {
+            return false;
+        }
+    } else if (display->primary) {
+        surface = (data->format == display->config.pixel_format) ? ESPIDF_CreateFlipSurface(w, h) : NULL;
+        if (!surface && ESPIDF_WantAsyncPresent()) {
+            surface = ESPIDF_CreateAsyncSurface(data, w, h, data->format);
+        }
+    }
     if (!surface) {
-        return SDL_SetError("Couldn't find ESPIDF surface for window");
+        surface = ESPIDF_CreateSyncSurface(data, w, h, data->format);
+    }
+    if (!surface) {
+        return false;
+    }
+    data->surface = surface;
+    data->placed_pitch = surface->pitch;
+    display->window = window;
+    ESPIDF_ReportWindowFormat(window);
+
+    ESPIDF_PlaceWindow(window, w, h);
+    if (display->primary) {
+        ESPIDF_UpdatePresentation(window, w, h);
+    }
+
+    *format = surface->format;
+    *pixels = surface->pixels;
+    *pitch = surface->pitch;
+
+    if (!ESPIDF_SetupFlush(window, w, h)) {
+        SDL_ESPIDF_DestroyWindowFramebuffer(_this, window);
+        return false;
     }
+    if (!ESPIDF_IsFlipPresent(data) && !ESPIDF_IsBouncePresent(data)) {
+        ESPIDF_CreateTileDiff(&data->diff, w, h);
+    }
+    return true;
+}
+
+SDL_Surface *ESPIDF_CreateBandSurface(SDL_Window *window, int rows)
+{
+    SDL_WindowData *data = window->internal;
+    SDL_DisplayData *display = data->display;
+    SDL_Surface *surface;
+    int w, h;
+
+    if (!ESPIDF_ClaimPanel(window)) {
+        return NULL;
+    }
+    if (data->surface) {
+        SDL_SetError("Window has a framebuffer, destroy its surface before rendering in bands");
+        return NULL;
+    }
+    if (ESPIDF_IsBouncePanel(display)) {
+        SDL_SetError("Panel has no frame buffer to keep the bands, use SDL_ESPIDF_SetScanoutCallback()");
+        return NULL;
+    }
+
+    SDL_GetWindowSizeInPixels(window, &w, &h);
+    ESPIDF_PlaceWindow(window, w, h);
+    if (display->primary) {
+        // Bands must start on window rows that map to whole display rows
+        ESPIDF_UpdatePresentation(window, w, h);
+        int align = ESPIDF_ScaleAlignmentY(data);
+        rows = SDL_max(rows / align * align, align);
+    }
+    rows = SDL_clamp(rows, 1, h);
+
+    // The software renderer draws RGB565 straight into the band, 18/24-bit panels get it expanded
+    ESPIDF_ConfigureSurfacePlacement(data, window);
+    data->format = SDL_PIXELFORMAT_RGB565;
+    surface = ESPIDF_CreateSyncSurface(data, w, rows, data->format);
+    if (!surface) {
+        return NULL;
+    }
+    data->surface = surface;
+    data->placed_pitch = surface->pitch;
+    data->band_h = h;
+    display->window = window;
+
+    if (!ESPIDF_SetupFlush(window, w, rows)) {
+        SDL_ESPIDF_DestroyWindowFramebuffer(SDL_GetVideoDevice(), window);
+        data->band_h = 0;
+        return NULL;
+    }
+    ESP_LOGI(TAG, "Window %dx%d renders in bands of %d rows", w, h, rows);
+    return surface;
+}
+
+#ifndef CONFIG_IDF_TARGET_ESP32P4
+// The panel takes the surface byte order, so the region's full rows are sent as they are
+static IRAM_ATTR void ESPIDF_FlushRectFromSurface(SDL_WindowData *data, SDL_Surface *surface, const SDL_Rect *rect)
+{
+    int rows_per_transfer = (surface->pitch == surface->w * SDL_BYTESPERPIXEL(surface->format)) ? data->max_chunk_height : 1;
+    SDL_Rect present_rect = ESPIDF_GetPanelRect(data);
+
+#ifdef CONFIG_SDL_ESPIDF_ZERO_COPY
+    uint8_t *first_row = (uint8_t *)surface->pixels + rect->y * surface->pitch;
+    if (esp_ptr_external_ram(first_row)) {
+        // The DMA reads PSRAM behind the data cache, write the dirty rows back first
+        ESP_ERROR_CHECK(esp_cache_msync(first_row, (size_t)rect->h * surface->pitch,
+                                        ESP_CACHE_MSYNC_FLAG_DIR_C2M | ESP_CACHE_MSYNC_FLAG_UNALIGNED));
+    }
+#endif
+
+    for (int y = rect->y; y < rect->y + rect->h; y += rows_per_transfer) {
+        int height = SDL_min(rows_per_transfer, rect->y + rect->h - y);
+
+        int panel_y = present_rect.y + data->band_y + y;
+
+        ESPIDF_BeginTransfer(data);
+        ESP_ERROR_CHECK(esp_lcd_panel_draw_bitmap(data->display->panel_handle, present_rect.x, panel_y, present_rect.x + surface->w, panel_y + height,
+                                                  (uint8_t *)surface->pixels + y * surface->pitch));
+        ESPIDF_STATS_CHUNK(data, surface->w, height);
+    }
+}
+#endif
 
+#if !defined(CONFIG_IDF_TARGET_ESP32P4) && !defined(CONFIG_SDL_ESPIDF_ZERO_COPY)
+// Convert count pixels of a window row, starting at pixel x, into the panel format
+static IRAM_ATTR void ESPIDF_ConvertRow(SDL_WindowData *data, uint8_t *dst, const uint8_t *row, int x, int count, SDL_PixelFormat format)
+{
+    if (data->convert_24) {
+        data->convert_24(dst, row + x * SDL_BYTESPERPIXEL(format), count);
+    } else if (data->expand_pixels) {
+        data->expand_pixels((uint16_t *)dst, row, x, count, data->expand_lut.colors);
+    } else {
+        data->convert_rgb565((uint16_t *)dst, (const uint16_t *)row + x, count);
+    }
+}
+
+// Convert height window rows of a region into a chunk of display rows, every pixel widened to sx x sy
+static IRAM_ATTR void ESPIDF_ConvertScaledChunk(SDL_WindowData *data, uint8_t *chunk, const SDL_Surface *surface, const SDL_Rect *rect,
+                                                int y, int height, int sx, int sy)
+{
+    int bpp = ESPIDF_PanelBytesPerPixel(data->display);
+    size_t out_pitch = (size_t)rect->w * sx * bpp;
+    const uint8_t *row = (const uint8_t *)surface->pixels + y * surface->pitch;
+
+    for (int i = 0; i < height; i++) {
+        uint8_t *out = chunk + i * sy * out_pitch;
+
+        // Converted into the end of the first display row, then widened over the whole row in place
+        ESPIDF_ConvertRow(data, out + (size_t)(sx - 1) * rect->w * bpp, row, rect->x, rect->w, surface->format);
+        if (sx > 1) {
+            ESPIDF_ReplicatePixels(out, rect->w, sx, bpp);
+        }
+        for (int k = 1; k < sy; k++) {
+            SDL_memcpy(out + k * out_pitch, out, out_pitch);
+        }
+        row += surface->pitch;
+    }
+}
+#endif
+
+#ifdef CONFIG_IDF_TARGET_ESP32P4
+// Hand the oldest queued PPA output to the panel once the PPA has finished it
+static IRAM_ATTR void ESPIDF_DrawPPAOutput(SDL_WindowData *data, uint8_t *buf, const SDL_Rect *out)
+{
+    ESPIDF_STATS_START(start);
+    xSemaphoreTake(data->ppa_done_semaphore, portMAX_DELAY);
+    ESPIDF_STATS_STAGE(data, ESPIDF_STAGE_PPA, start);
+    ESP_ERROR_CHECK(esp_lcd_panel_draw_bitmap(data->display->panel_handle, out->x, out->y, out->x + out->w, out->y + out->h, buf));
+    ESPIDF_STATS_CHUNK(data, out->w, out->h);
+}
+
+// Scale and rotate a region through the PPA ring, chunk k+1 is scaled while chunk k is copied to the panel
+static IRAM_ATTR void ESPIDF_FlushRectPPA(SDL_WindowData *data, SDL_Surface *surface, const SDL_Rect *rect)
+{
+    uint8_t *pending_buf = NULL;  // PPA output queued but not yet handed to the panel
+    SDL_Rect pending_out;
+    bool rgb_swap;
+    ppa_srm_color_mode_t in_mode = ESPIDF_PPAInputMode(surface->format, &rgb_swap);
+    int dw, dh;
+
+    ESPIDF_GetRotatedSize(&dw, &dh);
+    for (int y = rect->y; y < rect->y + rect->h; y += data->max_chunk_height) {
+        int height = SDL_min(data->max_chunk_height, rect->y + rect->h - y);
+
+        if (pending_buf && data->lcd_ring_depth == 1) {
+            // A single buffer cannot overlap, its slot only frees up once the queued chunk is drawn
+            ESPIDF_DrawPPAOutput(data, pending_buf, &pending_out);
+            pending_buf = NULL;
+        }
+
+        // Slots are released in order, so the next ring buffer has left for the panel once one is free
+        ESPIDF_BeginTransfer(data);
+        uint8_t *out_buf = data->ppa_out_ring[data->ppa_ring_next];
+        data->ppa_ring_next = (data->ppa_ring_next + 1) % data->lcd_ring_depth;
+
+        // Where the scaled chunk lands on the panel once the PPA has turned it
+        SDL_Rect chunk = { rect->x, data->band_y + y, rect->w, height };
+        SDL_Rect scaled = ESPIDF_ScaleRect(data, &chunk);
+        SDL_Rect out = ESPIDF_RotateRect(&scaled, dw, dh);
+
+        // PPA SRM configuration for scaling, rotation and conversion to the panel format, the block offset crops the
+        // region out of the surface
+        ppa_srm_oper_config_t srm_config = {
+            .in.buffer = surface->pixels,
+            .in.pic_w = surface->pitch / SDL_BYTESPERPIXEL(surface->format),
+            .in.pic_h = surface->h,
+            .in.block_w = rect->w,
+            .in.block_h = height,
+            .in.block_offset_x = rect->x,
+            .in.block_offset_y = y,
+            .in.srm_cm = in_mode,
+
+            .out.srm_cm = ESPIDF_PPAOutputMode(data->display),
+            .out.buffer = out_buf,
+            .out.buffer_size = data->ppa_out_buf_size,
+            .out.pic_w = out.w,
+            .out.pic_h = out.h,
+
+            .rotation_angle = ESPIDF_PPARotation(data),
+            .scale_x = (float)ESPIDF_GetScaleX16(data) / ESPIDF_SCALE_ONE,
+            .scale_y = (float)ESPIDF_GetScaleY16(data) / ESPIDF_SCALE_ONE,
+
+            .rgb_swap = rgb_swap,
+            // Only RGB565 windows reach SPI/i80 panels on the P4, the PPA swaps them into panel byte order
+            .byte_swap = !data->display->cpu_byte_order,
+            .mode = PPA_TRANS_MODE_NON_BLOCKING,
+            .user_data = data,
+        };
+        ESPIDF_STATS_START(ppa_start);
+        ESP_ERROR_CHECK(ppa_do_scale_rotate_mirror(data->ppa_srm_handle, &srm_config));
+        ESPIDF_STATS_STAGE(data, ESPIDF_STAGE_PPA, ppa_start);
+
+        // While the PPA works on this chunk, the previous one goes to the panel
+        if (pending_buf) {
+            ESPIDF_DrawPPAOutput(data, pending_buf, &pending_out);
+        }
+        pending_buf = out_buf;
+        pending_out = out;
+    }
+
+    if (pending_buf) {
+        ESPIDF_DrawPPAOutput(data, pending_buf, &pending_out);
+    }
+}
+#endif
+
+// Send one clipped region of the surface to the panel in chunks of data->max_chunk_height rows,
+// band surfaces land data->band_y rows down the window
+static IRAM_ATTR void ESPIDF_FlushRect(SDL_WindowData *data, SDL_Surface *surface, const SDL_Rect *rect)
+{
 #ifdef CONFIG_IDF_TARGET_ESP32P4
-    // Iterate over the framebuffer in chunks
-    for (int y = 0; y < surface->h; y += max_chunk_height) {
-        int height = (y + max_chunk_height > surface->h) ? (surface->h - y) : max_chunk_height;
-        uint16_t *src_pixels = (uint16_t *)surface->pixels + (y * surface->w);
-
-        if (scale_factor != 1) {
-            // PPA SRM configuration for scaling
-            ppa_srm_oper_config_t srm_config = {
-                .in.buffer = src_pixels,
-                .in.pic_w = surface->w,
-                .in.pic_h = height,
-                .in.block_w = surface->w,
-                .in.block_h = height,
-                .in.srm_cm = PPA_SRM_COLOR_MODE_RGB565,
-
-                .out.srm_cm = PPA_SRM_COLOR_MODE_RGB565,
-                .out.buffer = ppa_out_buf,
-                .out.buffer_size = ppa_out_buf_size,  // Reused output buffer
-                .out.pic_w = surface->w * scale_factor,
-                .out.pic_h = height * scale_factor,
-
-                .rotation_angle = PPA_SRM_ROTATION_ANGLE_0,  // No rotation
-                .scale_x = scale_factor_float,
-                .scale_y = scale_factor_float,
-
-                .rgb_swap = 0,
-                .byte_swap = 0,
-                .mode = PPA_TRANS_MODE_BLOCKING,
-            };
-
-            // Execute PPA scaling
-            ESP_ERROR_CHECK(ppa_do_scale_rotate_mirror(ppa_srm_handle, &srm_config));
-
-            // Draw the scaled output to the LCD
-            ESP_ERROR_CHECK(esp_lcd_panel_draw_bitmap(panel_handle, 0, y * scale_factor, surface->w * scale_factor, (y + height) * scale_factor, ppa_out_buf));
+    if (ESPIDF_UsePPA(data)) {
+        ESPIDF_FlushRectPPA(data, surface, rect);
+        return;
+    }
+
+    SDL_Rect present_rect = ESPIDF_GetPanelRect(data);
+    for (int y = rect->y; y < rect->y + rect->h; y += data->max_chunk_height) {
+        int height = SDL_min(data->max_chunk_height, rect->y + rect->h - y);
+
+        // Rows are sent straight from the surface, so the region always spans full rows here
+        ESPIDF_BeginTransfer(data);
+        uint8_t *src_pixels = (uint8_t *)surface->pixels + y * surface->pitch;
+        int panel_y = present_rect.y + data->band_y + y;
+        ESP_ERROR_CHECK(esp_lcd_panel_draw_bitmap(data->display->panel_handle, present_rect.x, panel_y,
+                                                  present_rect.x + surface->w, panel_y + height, src_pixels));
+        ESPIDF_STATS_CHUNK(data, surface->w, height);
+    }
+#elif defined(CONFIG_SDL_ESPIDF_ZERO_COPY)
+    ESPIDF_FlushRectFromSurface(data, surface, rect);
+#else
+    if (ESPIDF_ScanOutFromSurface(data, surface)) {
+        ESPIDF_FlushRectFromSurface(data, surface, rect);
+        return;
+    }
+
+    // Without PPA, convert each chunk of the region into the next free ring slot
+    int sx = ESPIDF_ReplicateX(data);
+    int sy = ESPIDF_ReplicateY(data);
+    for (int y = rect->y; y < rect->y + rect->h; y += data->max_chunk_height) {
+        int height = SDL_min(data->max_chunk_height, rect->y + rect->h - y);
+
+        // Slots complete in submission order, so the next one is free once a slot is released
+        ESPIDF_BeginTransfer(data);
+        uint8_t *chunk_bytes = data->chunk_ring[data->chunk_ring_next];
+        uint16_t *chunk = (uint16_t *)chunk_bytes;
+        data->chunk_ring_next = (data->chunk_ring_next + 1) % data->lcd_ring_depth;
+        const uint8_t *row = (const uint8_t *)surface->pixels + y * surface->pitch;
+        const uint16_t *src = (const uint16_t *)row + rect->x;
+
+        ESPIDF_STATS_START(convert_start);
+        if (sx > 1 || sy > 1) {
+            ESPIDF_ConvertScaledChunk(data, chunk_bytes, surface, rect, y, height, sx, sy);
+        } else if (data->convert_24) {
+            // 18/24-bit panels take three bytes per pixel, copied from native rows or expanded from RGB565
+            const uint8_t *src_row = row + rect->x * SDL_BYTESPERPIXEL(surface->format);
+            for (int i = 0; i < height; i++) {
+                data->convert_24(chunk_bytes + i * rect->w * 3, src_row, rect->w);
+                src_row += surface->pitch;
+            }
+        } else if (data->expand_pixels) {
+            // Reduced-depth rows are looked up pixel by pixel, one row at a time
+            for (int i = 0; i < height; i++) {
+                data->expand_pixels(chunk + i * rect->w, row, rect->x, rect->w, data->expand_lut.colors);
+                row += surface->pitch;
+            }
+        } else if (rect->w == surface->w && surface->pitch == surface->w * (int)sizeof(uint16_t)) {
+            // Full unpadded rows are contiguous, the whole chunk is converted in one call
+            data->convert_rgb565(chunk, src, rect->w * height);
+        } else {
+            for (int row = 0; row < height; row++) {
+                data->convert_rgb565(chunk + row * rect->w, src, rect->w);
+                src = (const uint16_t *)((const uint8_t *)src + surface->pitch);
+            }
+        }
+        ESPIDF_STATS_STAGE(data, ESPIDF_STAGE_CONVERT, convert_start);
+
+        // Queue the chunk and go on converting the next one while it is transmitted
+        SDL_Rect out = { rect->x, data->band_y + y, rect->w, height };
+        if (data->display->primary) {
+            // Widened and moved to where the logical presentation puts the window
+            out = ESPIDF_ScaleRect(data, &out);
         } else {
-            // Draw the scaled output to the LCD
-            ESP_ERROR_CHECK(esp_lcd_panel_draw_bitmap(panel_handle, 0, y, surface->w, (y + height), src_pixels));
+            out.x += data->x;
+            out.y += data->y;
         }
+        ESP_ERROR_CHECK(esp_lcd_panel_draw_bitmap(data->display->panel_handle, out.x, out.y, out.x + out.w, out.y + out.h, chunk_bytes));
+        ESPIDF_STATS_CHUNK(data, out.w, out.h);
+    }
+#endif
+}
+
+// Row parity the present sends on SPI/i80 panels, -1 to send all rows
+static int ESPIDF_SelectField(SDL_WindowData *data, bool full_frame)
+{
+    bool on;
+
+    // Bands, scaled and PPA-turned windows do not map window rows 1:1 to panel rows
+    if (data->display->panel_interface != ESPIDF_PANEL_IO || data->band_renderer || ESPIDF_IsScaled(data)) {
+        return -1;
+    }
+#ifdef CONFIG_IDF_TARGET_ESP32P4
+    if (ESPIDF_UsePPA(data)) {
+        return -1;
+    }
+#endif
+
+    // Full-frame presents in a row mean motion, the first partial one that it stopped
+    data->motion_frames = full_frame ? data->motion_frames + 1 : 0;
+    switch (data->interlace) {
+    case ESPIDF_INTERLACE_ON:
+        on = true;
+        break;
+    case ESPIDF_INTERLACE_AUTO:
+        on = data->motion_frames >= ESPIDF_INTERLACE_MOTION_FRAMES;
+        break;
+    default:
+        on = false;
+        break;
+    }
+    if (!on) {
+        return -1;
+    }
+    data->field ^= 1;
+    return data->field;
+}
 
-        // Wait for the current chunk to finish transmission
-        xSemaphoreTake(lcd_semaphore, portMAX_DELAY);
+// Send the rows of one parity of a region, each row gets its own panel window
+static IRAM_ATTR void ESPIDF_FlushField(SDL_WindowData *data, SDL_Surface *surface, const SDL_Rect *rect, int field)
+{
+    for (int y = rect->y + ((rect->y + field) & 1); y < rect->y + rect->h; y += 2) {
+        const SDL_Rect row = { rect->x, y, rect->w, 1 };
+        ESPIDF_FlushRect(data, surface, &row);
     }
+}
+
+IRAM_ATTR void ESPIDF_FlushSurface(SDL_WindowData *data, SDL_Surface *surface, const SDL_Rect *rects, int numrects)
+{
+    SDL_Rect regions[ESPIDF_MAX_DIRTY_RECTS + 1];
+    int count = ESPIDF_DiffDirtyRects(&data->diff, surface, rects, numrects, regions);
+    Sint64 dirty_area = 0;
+
+#ifdef CONFIG_IDF_TARGET_ESP32P4
+    if (ESPIDF_UsePPA(data)) {
+        // Fractional scales need region edges that land on whole display pixels
+        for (int i = 0; i < count; i++) {
+            ESPIDF_AlignRectToScale(data, &regions[i], surface->w, surface->h);
+        }
+        SDL_Rect aligned[ESPIDF_MAX_DIRTY_RECTS];
+        SDL_memcpy(aligned, regions, count * sizeof(SDL_Rect));
+        count = ESPIDF_MergeDirtyRects(surface->w, surface->h, aligned, count, regions);
+    }
+#endif
+
+    if (ESPIDF_ScanOutFromSurface(data, surface)) {
+        // Chunks drawn straight from the surface need full rows
+        SDL_Rect rows[ESPIDF_MAX_DIRTY_RECTS];
+        for (int i = 0; i < count; i++) {
+            rows[i] = (SDL_Rect){ 0, regions[i].y, surface->w, regions[i].h };
+        }
+        count = ESPIDF_MergeDirtyRects(surface->w, surface->h, rows, count, regions);
+    }
+
+    for (int i = 0; i < count; i++) {
+        dirty_area += (Sint64)regions[i].w * regions[i].h;
+    }
+
+    // Past the threshold one full-frame push beats many small panel windows
+    bool full_frame = dirty_area * 100 > (Sint64)data->full_frame_percent * surface->w * surface->h;
+    if (full_frame) {
+        regions[0] = (SDL_Rect){ 0, 0, surface->w, surface->h };
+        count = 1;
+    }
+
+    int field = ESPIDF_SelectField(data, full_frame);
+    SDL_Rect pending = { 0, 0, 0, 0 };
+    if (field >= 0) {
+        // The other field of what changed now goes out with the next present
+        for (int i = 0; i < count; i++) {
+            SDL_GetRectUnion(&pending, &regions[i], &pending);
+        }
+    }
+    if (!SDL_RectEmpty(&data->field_pending)) {
+        // The field the last interlaced present skipped, this one sends the other parity or all rows
+        SDL_Rect merged[ESPIDF_MAX_DIRTY_RECTS];
+        regions[count++] = data->field_pending;
+        count = ESPIDF_MergeDirtyRects(surface->w, surface->h, regions, count, merged);
+        SDL_memcpy(regions, merged, count * sizeof(SDL_Rect));
+    }
+    data->field_pending = pending;
+
+    for (int i = 0; i < count; i++) {
+        if (field >= 0) {
+            ESPIDF_FlushField(data, surface, &regions[i], field);
+        } else {
+            ESPIDF_FlushRect(data, surface, &regions[i]);
+        }
+    }
+    // The tile hashes already hold the rows the skipped field still owes the panel. field_pending
+    // sends them whatever the next diff finds, so that diff only reports new motion.
+
+#ifdef CONFIG_IDF_TARGET_ESP32P4
+    // The last chunks may still be read from the surface or the PPA ring
+    ESPIDF_WaitForTransfers(data);
 #else
-    // Without PPA, send chunks directly from src_pixels
-    for (int y = 0; y < surface->h; y += max_chunk_height) {
-        int height = (y + max_chunk_height > surface->h) ? (surface->h - y) : max_chunk_height;
+    if (ESPIDF_ScanOutFromSurface(data, surface)) {
+        // The app may draw into the surface again as soon as the present returns
+        ESPIDF_WaitForTransfers(data);
+    }
+#endif
+}
 
-        for (int i = 0; i < surface->w * max_chunk_height; i++) {
-            uint16_t rgba = ((uint16_t *)surface->pixels)[y * surface->w + i];
-            uint8_t g = (rgba >> 11) & 0xFF;
-            uint8_t r = (rgba >> 5) & 0xFF;
-            uint8_t b = (rgba >> 0) & 0xFF;
+// Vsync wait of a present, returns the time waited so the frame budget can leave it out
+static int64_t ESPIDF_PaceWindowFrame(int latency)
+{
+    int64_t start = esp_timer_get_time();
+
+    ESPIDF_PaceFrame(latency);
+    return esp_timer_get_time() - start;
+}
 
-            rgb565_buffer[i] = ((b & 0xF8) << 8) | ((g & 0xFC) << 3) | (r >> 3);
+IRAM_ATTR bool SDL_ESPIDF_UpdateWindowFramebuffer(SDL_VideoDevice *_this, SDL_Window *window, const SDL_Rect *rects, int numrects)
+{
+    ESPIDF_STATS_START(lookup_start);
+    SDL_WindowData *data = window->internal;
+    SDL_Surface *surface = data->surface;
+    if (!surface) {
+        return SDL_SetError("Couldn't find ESPIDF surface for window");
+    }
+    ESPIDF_STATS_LOOKUP(data, lookup_start);
+
+    const SDL_Rect whole = { 0, 0, surface->w, surface->h };
+
+    if (data->moved) {
+        // The window is drawn at its new place as a whole
+        rects = &whole;
+        numrects = 1;
+        data->moved = false;
+    }
+
+#if defined(CONFIG_IDF_TARGET_ESP32P4) || !defined(CONFIG_SDL_ESPIDF_ZERO_COPY)
+    // A logical presentation set on the renderer is done by the PPA or the flush, the renderer then draws 1:1,
+    // or at a reduced size while frames run over the frame budget
+    if (data->display->primary && ESPIDF_FollowLogicalPresentation(window) && !ESPIDF_IsFlipPresent(data) &&
+        !ESPIDF_IsBouncePresent(data)) {
+        if (!ESPIDF_ReconfigurePresentation(window, surface)) {
+            return false;
         }
-        // Send directly to LCD
-        ESP_ERROR_CHECK(esp_lcd_panel_draw_bitmap(panel_handle, 0, y, surface->w, y + height, rgb565_buffer));
+        // The whole window goes out at its new scale
+        rects = &whole;
+        numrects = 1;
+    }
+#endif
 
-        // Wait for the current chunk to finish transmission
-        xSemaphoreTake(lcd_semaphore, portMAX_DELAY);
+#if !defined(CONFIG_IDF_TARGET_ESP32P4) && !defined(CONFIG_SDL_ESPIDF_ZERO_COPY)
+    // The app sets the colors of an indexed window on the surface SDL_GetWindowSurface returned
+    SDL_Palette *palette = window->surface ? SDL_GetSurfacePalette(window->surface) : NULL;
+    if (ESPIDF_ExpandPaletteChanged(&data->expand_lut, palette)) {
+        if (ESPIDF_IsAsyncPresent(data)) {
+            // The flush task expands the frames already submitted through the old colors, they were drawn with them
+            SDL_ESPIDF_WaitForFrame(window, data->submitted_frame, -1);
+        }
+        ESPIDF_UpdateExpandPalette(&data->expand_lut, palette);
+        // Every pixel may have changed color without its index changing
+        ESPIDF_ResetTileDiff(&data->diff);
+        rects = &whole;
+        numrects = 1;
     }
 #endif
 
+    if (ESPIDF_IsFlipPresent(data)) {
+        // The surface becomes the scanned-out frame buffer and the app moves on to the next one,
+        // the flip itself lands at the following refresh
+        int64_t paced_us = ESPIDF_PaceWindowFrame(1);
+        ESPIDF_STATS_BEGIN_FRAME(data);
+        ESPIDF_FlipSurface(window, surface);
+        ESPIDF_CompleteSyncFrame(data);
+        ESPIDF_STATS_END_FRAME(data);
+        ESPIDF_TrackFrameBudget(window, paced_us);
+        return true;
+    }
+
+    if (ESPIDF_IsBouncePresent(data)) {
+        // The panel ISR switches to the surface when the next frame starts, nothing is sent from here
+        int64_t paced_us = ESPIDF_PaceWindowFrame(1);
+        ESPIDF_STATS_BEGIN_FRAME(data);
+        ESPIDF_BounceSurface(window, surface);
+        ESPIDF_CompleteSyncFrame(data);
+        ESPIDF_STATS_END_FRAME(data);
+        ESPIDF_TrackFrameBudget(window, paced_us);
+        return true;
+    }
+
+    if (ESPIDF_IsAsyncPresent(data)) {
+        // The flush task takes over the finished frame and the app continues on a fresh back buffer,
+        // the flush runs beside the next render and only the render counts against the frame budget
+        ESPIDF_SubmitAsyncFrame(window, surface, rects, numrects);
+        ESPIDF_TrackFrameBudget(window, 0);
+        return true;
+    }
+
+    int64_t paced_us = 0;
+    if (data->display->primary) {
+        // Vsync pacing follows the refreshes of the primary panel
+        paced_us = ESPIDF_PaceWindowFrame(0);
+    }
+    ESPIDF_STATS_BEGIN_FRAME(data);
+    ESPIDF_FlushSurface(data, surface, rects, numrects);
+    ESPIDF_CompleteSyncFrame(data);
+    ESPIDF_STATS_END_FRAME(data);
+    if (data->display->primary) {
+        ESPIDF_TrackFrameBudget(window, paced_us);
+    }
+
     return true;
 }
 
 void SDL_ESPIDF_DestroyWindowFramebuffer(SDL_VideoDevice *_this, SDL_Window *window)
 {
-    SDL_ClearProperty(SDL_GetWindowProperties(window), ESPIDF_SURFACE);
+    SDL_WindowData *data = window->internal;
 
-    // Delete the semaphore
-    if (lcd_semaphore) {
-        vSemaphoreDelete(lcd_semaphore);
-        lcd_semaphore = NULL;
+    if (!data || data->band_renderer) {
+        // Bands keep their surface until the band renderer goes away
+        return;
     }
 
-#ifdef CONFIG_IDF_TARGET_ESP32P4
-    // Free PPA output buffer
-    if (ppa_out_buf) {
-        heap_caps_free(ppa_out_buf);
-        ppa_out_buf = NULL;
-        ppa_out_buf_size = 0;
+    if (data->display->primary) {
+        // Stop the flush task before the surface and its back buffers go away
+        ESPIDF_DestroyAsyncPresent();
+        ESPIDF_DestroyFlipPresent();
+        ESPIDF_DestroyBouncePresent();
+        ESPIDF_StopRefreshSource();
     }
 
-    if (ppa_srm_handle) {
-        ESP_ERROR_CHECK(ppa_unregister_client(ppa_srm_handle));
-        ppa_srm_handle = NULL;
+    ESPIDF_DestroyTileDiff(&data->diff);
+    SDL_RemoveHintCallback(SDL_HINT_ESPIDF_INTERLACE, ESPIDF_InterlaceHintChanged, data);
+
+    // Delete the semaphore once nothing is in flight anymore
+    if (data->lcd_semaphore) {
+        ESPIDF_WaitForTransfers(data);
+        // The panel ISRs keep running, they must not reach the window data anymore
+        ESPIDF_RegisterPanelCallbacks(data->display, NULL);
+        vSemaphoreDelete(data->lcd_semaphore);
+        data->lcd_semaphore = NULL;
     }
-#else
-    // Free the RGB565 buffer
-    if (rgb565_buffer) {
-        heap_caps_free(rgb565_buffer);
-        rgb565_buffer = NULL;
+
+#ifdef CONFIG_IDF_TARGET_ESP32P4
+    // Free the PPA output ring
+    ESPIDF_FreePPARing(data);
+
+    if (data->ppa_srm_handle) {
+        ESP_ERROR_CHECK(ppa_unregister_client(data->ppa_srm_handle));
+        data->ppa_srm_handle = NULL;
+        vSemaphoreDelete(data->ppa_done_semaphore);
+        data->ppa_done_semaphore = NULL;
     }
+#elif !defined(CONFIG_SDL_ESPIDF_ZERO_COPY)
+    ESPIDF_FreeChunkRing(data);
 #endif
+
+    if (data->surface) {
+        SDL_DestroySurface(data->surface);
+        data->surface = NULL;
+    }
+    if (data->display->window == window) {
+        data->display->window = NULL;
+    }
+
+    // The surface does not own its pixels, they are freed here
+    if (data->surface_pixels) {
+        heap_caps_free(data->surface_pixels);
+        data->surface_pixels = NULL;
+    }
 }
 
 #endif /* SDL_VIDEO_DRIVER_PRIVATE */
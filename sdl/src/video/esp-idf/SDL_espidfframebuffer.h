@@ -6,5 +6,32 @@
 extern bool SDL_ESPIDF_CreateWindowFramebuffer(SDL_VideoDevice *_this, SDL_Window *window, SDL_PixelFormat *format, void **pixels, int *pitch);
 extern bool SDL_ESPIDF_UpdateWindowFramebuffer(SDL_VideoDevice *_this, SDL_Window *window, const SDL_Rect *rects, int numrects);
 extern void SDL_ESPIDF_DestroyWindowFramebuffer(SDL_VideoDevice *_this, SDL_Window *window);
+// Follow a new window position, clears the panel area the window left
+extern void ESPIDF_MoveWindowFramebuffer(SDL_Window *window);
+// Surface of rows window rows, set up for flushing like a window framebuffer
+extern SDL_Surface *ESPIDF_CreateBandSurface(SDL_Window *window, int rows);
+
+// Upper bound of disjoint regions flushed per present, further rects are folded in
+#define ESPIDF_MAX_DIRTY_RECTS 8
+
+// Window pixel buffers are aligned to the data cache line by default, so cache write-backs never touch neighbours
+#define ESPIDF_SURFACE_ALIGN 64
+
+// Window format the driver picks for a w x h window on the panel, reported as its display mode
+extern SDL_PixelFormat ESPIDF_NegotiatePanelFormat(const SDL_DisplayData *display, int w, int h);
+extern int ESPIDF_SurfacePitch(const SDL_WindowData *data, int w, SDL_PixelFormat format);
+// Window surface pixels with the heap caps and alignment picked for the window, zeroed
+extern void *ESPIDF_AllocSurfacePixels(SDL_WindowData *data, size_t size);
+extern int ESPIDF_MergeDirtyRects(int w, int h, const SDL_Rect *rects, int numrects, SDL_Rect *merged);
+extern void ESPIDF_FlushSurface(SDL_WindowData *data, SDL_Surface *surface, const SDL_Rect *rects, int numrects);
+// Hook the panel events up to the driver, data is handed to the ISRs and may be NULL
+extern void ESPIDF_RegisterPanelCallbacks(SDL_DisplayData *display, SDL_WindowData *data);
+extern void ESPIDF_BeginTransfer(SDL_WindowData *data);
+extern void ESPIDF_WaitForTransfers(SDL_WindowData *data);
+extern bool ESPIDF_TransfersIdle(const SDL_WindowData *data);
+// Panel area the window covers, on the primary panel as the presentation scales it
+extern SDL_Rect ESPIDF_GetPanelRect(const SDL_WindowData *data);
+// data may be NULL when no window surface has been placed yet
+extern void esp_idf_log_free_dma(const SDL_WindowData *data);
 
 #endif
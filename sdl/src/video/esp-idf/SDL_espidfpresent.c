@@ -0,0 +1,291 @@
+#include "SDL_internal.h"
+
+#ifdef SDL_VIDEO_DRIVER_PRIVATE
+
+#include "video/SDL_sysvideo.h"
+#include "SDL_espidfframebuffer.h"
+#include "SDL_espidfpresent.h"
+#include "SDL_espidfwindow.h"
+#include "SDL_espidfstats.h"
+#include "SDL_espidfvsync.h"
+#include "SDL3/SDL_esp-idf.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#ifdef CONFIG_SDL_ESPIDF_ASYNC_PRESENT
+
+static const char *TAG = "SDL_espidfpresent";
+
+#define ESPIDF_ASYNC_BUFFERS 3
+
+/*
+ * Triple buffering: the app renders into the back buffer, the last finished
+ * frame waits in the pending slot and the flush task sends the front buffer.
+ * A frame submitted while another is still pending replaces it (latest frame
+ * wins) and inherits its dirty rects, so the panel never misses an update.
+ */
+static TaskHandle_t flush_task = NULL;
+static SDL_WindowData *async_data = NULL;         // Window the flush task presents, on the primary panel
+static SemaphoreHandle_t async_lock = NULL;       // Guards the buffer indices and pending rects
+static SemaphoreHandle_t frame_done_semaphore = NULL;
+static SemaphoreHandle_t flush_task_exited = NULL;
+static volatile bool flush_task_quit = false;
+static uint8_t *async_pixels[ESPIDF_ASYNC_BUFFERS];
+static SDL_Surface *async_surface = NULL;
+static int back_index = 0;
+static int pending_index = -1;
+static int front_index = -1;
+static Uint64 pending_frame = 0;
+static SDL_Rect pending_rects[ESPIDF_MAX_DIRTY_RECTS];
+static int pending_numrects = 0;
+
+static void ESPIDF_FlushTask(void *arg)
+{
+    SDL_Surface front = *async_surface;
+    SDL_Rect rects[ESPIDF_MAX_DIRTY_RECTS];
+
+    while (!flush_task_quit) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        xSemaphoreTake(async_lock, portMAX_DELAY);
+        int index = pending_index;
+        int numrects = pending_numrects;
+        Uint64 frame = pending_frame;
+        if (index >= 0) {
+            SDL_memcpy(rects, pending_rects, numrects * sizeof(SDL_Rect));
+            front_index = index;
+            pending_index = -1;
+        }
+        xSemaphoreGive(async_lock);
+
+        if (index < 0) {
+            continue;
+        }
+
+        front.pixels = async_pixels[index];
+        ESPIDF_PaceFrame(0);
+        ESPIDF_STATS_BEGIN_FRAME(async_data);
+        ESPIDF_FlushSurface(async_data, &front, rects, numrects);
+        ESPIDF_WaitForTransfers(async_data);
+        ESPIDF_STATS_END_FRAME(async_data);
+
+        xSemaphoreTake(async_lock, portMAX_DELAY);
+        front_index = -1;
+        async_data->completed_frame = frame;
+        xSemaphoreGive(async_lock);
+        xSemaphoreGive(frame_done_semaphore);
+    }
+
+    xSemaphoreGive(flush_task_exited);
+    vTaskDelete(NULL);
+}
+
+#endif /* CONFIG_SDL_ESPIDF_ASYNC_PRESENT */
+
+bool ESPIDF_WantAsyncPresent(void)
+{
+#ifdef CONFIG_SDL_ESPIDF_ASYNC_PRESENT
+    return SDL_GetHintBoolean(SDL_HINT_ESPIDF_ASYNC_PRESENT, true);
+#else
+    return false;
+#endif
+}
+
+SDL_Surface *ESPIDF_CreateAsyncSurface(SDL_WindowData *data, int w, int h, SDL_PixelFormat format)
+{
+#ifdef CONFIG_SDL_ESPIDF_ASYNC_PRESENT
+    int pitch = ESPIDF_SurfacePitch(data, w, format);
+
+    for (int i = 0; i < ESPIDF_ASYNC_BUFFERS; i++) {
+        // Placed like the synchronous window surface, DMA-capable when the panel reads them directly
+        async_pixels[i] = ESPIDF_AllocSurfacePixels(data, (size_t)pitch * h);
+        if (!async_pixels[i]) {
+            ESPIDF_DestroyAsyncPresent();
+            SDL_SetError("Failed to allocate async present buffer %d", i);
+            return NULL;
+        }
+    }
+
+    async_surface = SDL_CreateSurfaceFrom(w, h, format, async_pixels[0], pitch);
+    async_lock = xSemaphoreCreateMutex();
+    frame_done_semaphore = xSemaphoreCreateBinary();
+    flush_task_exited = xSemaphoreCreateBinary();
+    if (!async_surface || !async_lock || !frame_done_semaphore || !flush_task_exited) {
+        SDL_DestroySurface(async_surface);
+        ESPIDF_DestroyAsyncPresent();
+        SDL_SetError("Failed to set up async present");
+        return NULL;
+    }
+
+    back_index = 0;
+    pending_index = -1;
+    front_index = -1;
+    pending_numrects = 0;
+    flush_task_quit = false;
+    async_data = data;
+    if (xTaskCreatePinnedToCore(ESPIDF_FlushTask, "sdl_flush", CONFIG_SDL_ESPIDF_FLUSH_TASK_STACK_SIZE, NULL,
+                                CONFIG_SDL_ESPIDF_FLUSH_TASK_PRIORITY, &flush_task, CONFIG_SDL_ESPIDF_FLUSH_TASK_CORE) != pdPASS) {
+        flush_task = NULL;
+        SDL_DestroySurface(async_surface);
+        ESPIDF_DestroyAsyncPresent();
+        SDL_SetError("Failed to create flush task");
+        return NULL;
+    }
+
+    ESP_LOGI(TAG, "Async present on core %d, %d buffers of %d bytes", CONFIG_SDL_ESPIDF_FLUSH_TASK_CORE, ESPIDF_ASYNC_BUFFERS, pitch * h);
+    return async_surface;
+#else
+    SDL_Unsupported();
+    return NULL;
+#endif
+}
+
+bool ESPIDF_IsAsyncPresent(const SDL_WindowData *data)
+{
+#ifdef CONFIG_SDL_ESPIDF_ASYNC_PRESENT
+    return flush_task != NULL && data == async_data;
+#else
+    return false;
+#endif
+}
+
+void ESPIDF_SubmitAsyncFrame(SDL_Window *window, SDL_Surface *surface, const SDL_Rect *rects, int numrects)
+{
+#ifdef CONFIG_SDL_ESPIDF_ASYNC_PRESENT
+    SDL_Rect merged[2 * ESPIDF_MAX_DIRTY_RECTS];
+    int count = ESPIDF_MergeDirtyRects(surface->w, surface->h, rects, numrects, merged);
+    int next;
+
+    xSemaphoreTake(async_lock, portMAX_DELAY);
+    if (pending_index >= 0) {
+        // Latest frame wins: recycle the unsent buffer and carry its dirty area over
+        next = pending_index;
+        SDL_memcpy(&merged[count], pending_rects, pending_numrects * sizeof(SDL_Rect));
+        count += pending_numrects;
+        pending_numrects = ESPIDF_MergeDirtyRects(surface->w, surface->h, merged, count, pending_rects);
+    } else {
+        next = 0;
+        while (next == back_index || next == front_index) {
+            next++;
+        }
+        SDL_memcpy(pending_rects, merged, count * sizeof(SDL_Rect));
+        pending_numrects = count;
+    }
+    pending_index = back_index;
+    pending_frame = ++async_data->submitted_frame;
+    back_index = next;
+    xSemaphoreGive(async_lock);
+
+    // Hand the app its new back buffer, its content is undefined as after SDL_RenderPresent
+    surface->pixels = async_pixels[next];
+    if (window->surface) {
+        window->surface->pixels = async_pixels[next];
+    }
+
+    xTaskNotifyGive(flush_task);
+#endif
+}
+
+void ESPIDF_DestroyAsyncPresent(void)
+{
+#ifdef CONFIG_SDL_ESPIDF_ASYNC_PRESENT
+    if (flush_task) {
+        flush_task_quit = true;
+        xTaskNotifyGive(flush_task);
+        xSemaphoreTake(flush_task_exited, portMAX_DELAY);
+        flush_task = NULL;
+    }
+    async_data = NULL;
+
+    // The surface itself belongs to the window data, it does not own these pixels
+    async_surface = NULL;
+    for (int i = 0; i < ESPIDF_ASYNC_BUFFERS; i++) {
+        if (async_pixels[i]) {
+            heap_caps_free(async_pixels[i]);
+            async_pixels[i] = NULL;
+        }
+    }
+    if (async_lock) {
+        vSemaphoreDelete(async_lock);
+        async_lock = NULL;
+    }
+    if (frame_done_semaphore) {
+        vSemaphoreDelete(frame_done_semaphore);
+        frame_done_semaphore = NULL;
+    }
+    if (flush_task_exited) {
+        vSemaphoreDelete(flush_task_exited);
+        flush_task_exited = NULL;
+    }
+#endif
+}
+
+void ESPIDF_CompleteSyncFrame(SDL_WindowData *data)
+{
+    data->completed_frame = ++data->submitted_frame;
+}
+
+Uint64 SDL_ESPIDF_GetLastSubmittedFrame(SDL_Window *window)
+{
+    if (!window || !window->internal) {
+        return 0;
+    }
+    return window->internal->submitted_frame;
+}
+
+bool SDL_ESPIDF_IsFrameOnPanel(SDL_Window *window, Uint64 frame)
+{
+    if (!window || !window->internal) {
+        return false;
+    }
+
+    SDL_WindowData *data = window->internal;
+#ifdef CONFIG_SDL_ESPIDF_ASYNC_PRESENT
+    if (ESPIDF_IsAsyncPresent(data)) {
+        xSemaphoreTake(async_lock, portMAX_DELAY);
+        bool done = frame <= data->completed_frame;
+        xSemaphoreGive(async_lock);
+        return done;
+    }
+#endif
+    // Synchronous presents return with the last chunks possibly still in the DMA ring
+    return frame <= data->completed_frame && ESPIDF_TransfersIdle(data);
+}
+
+bool SDL_ESPIDF_WaitForFrame(SDL_Window *window, Uint64 frame, Sint32 timeout_ms)
+{
+    if (!window || !window->internal) {
+        return SDL_InvalidParamError("window");
+    }
+
+    SDL_WindowData *data = window->internal;
+    if (frame > data->submitted_frame) {
+        return SDL_SetError("Frame %" SDL_PRIu64 " has not been presented yet", frame);
+    }
+
+#ifdef CONFIG_SDL_ESPIDF_ASYNC_PRESENT
+    if (ESPIDF_IsAsyncPresent(data)) {
+        TickType_t start = xTaskGetTickCount();
+        TickType_t timeout = timeout_ms < 0 ? portMAX_DELAY : pdMS_TO_TICKS((TickType_t)timeout_ms);
+
+        while (!SDL_ESPIDF_IsFrameOnPanel(window, frame)) {
+            TickType_t elapsed = xTaskGetTickCount() - start;
+            if (timeout != portMAX_DELAY && elapsed >= timeout) {
+                return false;
+            }
+            xSemaphoreTake(frame_done_semaphore, timeout == portMAX_DELAY ? portMAX_DELAY : timeout - elapsed);
+        }
+        return true;
+    }
+#endif
+
+    if (data->lcd_semaphore) {
+        ESPIDF_WaitForTransfers(data);
+    }
+    return true;
+}
+
+#endif /* SDL_VIDEO_DRIVER_PRIVATE */
@@ -0,0 +1,13 @@
+#ifndef SDL_espidfpresent_h_
+#define SDL_espidfpresent_h_
+
+#include "SDL_internal.h"
+
+extern bool ESPIDF_WantAsyncPresent(void);
+extern SDL_Surface *ESPIDF_CreateAsyncSurface(SDL_WindowData *data, int w, int h, SDL_PixelFormat format);
+extern bool ESPIDF_IsAsyncPresent(const SDL_WindowData *data);
+extern void ESPIDF_SubmitAsyncFrame(SDL_Window *window, SDL_Surface *surface, const SDL_Rect *rects, int numrects);
+extern void ESPIDF_DestroyAsyncPresent(void);
+extern void ESPIDF_CompleteSyncFrame(SDL_WindowData *data);
+
+#endif /* SDL_espidfpresent_h_ */
@@ -0,0 +1,174 @@
+#include "SDL_internal.h"
+
+#ifdef SDL_VIDEO_DRIVER_PRIVATE
+
+#include "video/SDL_sysvideo.h"
+#include "SDL_espidfrotate.h"
+#include "SDL_espidfshared.h"
+#include "SDL3/SDL_esp-idf.h"
+#include "esp_log.h"
+#include "esp_lcd_panel_ops.h"
+
+static const char *TAG = "SDL_espidfrotate";
+
+static int display_rotation = 0;
+
+#ifdef CONFIG_SDL_ESPIDF_PANEL_SWAP_XY
+#define ESPIDF_PANEL_SWAP_XY true
+#else
+#define ESPIDF_PANEL_SWAP_XY false
+#endif
+#ifdef CONFIG_SDL_ESPIDF_PANEL_MIRROR_X
+#define ESPIDF_PANEL_MIRROR_X true
+#else
+#define ESPIDF_PANEL_MIRROR_X false
+#endif
+#ifdef CONFIG_SDL_ESPIDF_PANEL_MIRROR_Y
+#define ESPIDF_PANEL_MIRROR_Y true
+#else
+#define ESPIDF_PANEL_MIRROR_Y false
+#endif
+
+/*
+ * SPI/i80 controllers rotate by exchanging and mirroring their address
+ * counters, RGB panels do the same while copying into their frame buffer.
+ * The settings are relative to the orientation the BSP left the panel in.
+ */
+static void ESPIDF_SetPanelRotation(int rotation)
+{
+    bool swap_xy = ESPIDF_PANEL_SWAP_XY;
+    bool mirror_x = ESPIDF_PANEL_MIRROR_X;
+    bool mirror_y = ESPIDF_PANEL_MIRROR_Y;
+
+    switch (rotation) {
+    case 90:
+        swap_xy = !swap_xy;
+        mirror_y = !mirror_y;
+        break;
+    case 180:
+        mirror_x = !mirror_x;
+        mirror_y = !mirror_y;
+        break;
+    case 270:
+        swap_xy = !swap_xy;
+        mirror_x = !mirror_x;
+        break;
+    default:
+        // Keep whatever the BSP configured
+        return;
+    }
+
+    esp_lcd_panel_handle_t panel_handle = ESPIDF_GetPrimaryPanel()->panel_handle;
+    if (esp_lcd_panel_swap_xy(panel_handle, swap_xy) != ESP_OK ||
+        esp_lcd_panel_mirror(panel_handle, mirror_x, mirror_y) != ESP_OK) {
+        ESP_LOGW(TAG, "Panel cannot rotate by %d degrees, keeping its native orientation", rotation);
+        esp_lcd_panel_swap_xy(panel_handle, ESPIDF_PANEL_SWAP_XY);
+        esp_lcd_panel_mirror(panel_handle, ESPIDF_PANEL_MIRROR_X, ESPIDF_PANEL_MIRROR_Y);
+        display_rotation = 0;
+    }
+}
+
+void ESPIDF_InitRotation(void)
+{
+    const char *hint = SDL_GetHint(SDL_HINT_ESPIDF_ROTATION);
+    int rotation = hint ? SDL_atoi(hint) : CONFIG_SDL_ESPIDF_ROTATION;
+
+    if (rotation != 0 && rotation != 90 && rotation != 180 && rotation != 270) {
+        ESP_LOGW(TAG, "Ignoring rotation of %d degrees, must be 0, 90, 180 or 270", rotation);
+        rotation = CONFIG_SDL_ESPIDF_ROTATION;
+    }
+    display_rotation = rotation;
+
+    // MIPI-DSI panels have no scan direction control, the PPA turns every chunk on its way to the panel
+    if (ESPIDF_GetPrimaryPanel()->panel_interface != ESPIDF_PANEL_DPI) {
+        ESPIDF_SetPanelRotation(rotation);
+    }
+
+    if (display_rotation != 0) {
+        ESP_LOGI(TAG, "Display rotated by %d degrees", display_rotation);
+    }
+}
+
+int ESPIDF_GetRotation(void)
+{
+    return display_rotation;
+}
+
+void ESPIDF_GetRotatedSize(int *w, int *h)
+{
+    bool swapped = (display_rotation == 90 || display_rotation == 270);
+    const esp_bsp_sdl_display_config_t *display_config = &ESPIDF_GetPrimaryPanel()->config;
+
+    *w = swapped ? display_config->height : display_config->width;
+    *h = swapped ? display_config->width : display_config->height;
+}
+
+SDL_DisplayOrientation ESPIDF_GetNaturalOrientation(void)
+{
+    const esp_bsp_sdl_display_config_t *display_config = &ESPIDF_GetPrimaryPanel()->config;
+
+    return (display_config->width >= display_config->height) ? SDL_ORIENTATION_LANDSCAPE : SDL_ORIENTATION_PORTRAIT;
+}
+
+SDL_DisplayOrientation ESPIDF_GetCurrentOrientation(void)
+{
+    static const SDL_DisplayOrientation from_landscape[] = {
+        SDL_ORIENTATION_LANDSCAPE, SDL_ORIENTATION_PORTRAIT, SDL_ORIENTATION_LANDSCAPE_FLIPPED, SDL_ORIENTATION_PORTRAIT_FLIPPED
+    };
+    static const SDL_DisplayOrientation from_portrait[] = {
+        SDL_ORIENTATION_PORTRAIT, SDL_ORIENTATION_LANDSCAPE, SDL_ORIENTATION_PORTRAIT_FLIPPED, SDL_ORIENTATION_LANDSCAPE_FLIPPED
+    };
+
+    if (ESPIDF_GetNaturalOrientation() == SDL_ORIENTATION_LANDSCAPE) {
+        return from_landscape[display_rotation / 90];
+    }
+    return from_portrait[display_rotation / 90];
+}
+
+SDL_Rect ESPIDF_RotateRect(const SDL_Rect *rect, int w, int h)
+{
+    SDL_Rect out;
+
+    switch (display_rotation) {
+    case 90:
+        out = (SDL_Rect){ h - (rect->y + rect->h), rect->x, rect->h, rect->w };
+        break;
+    case 180:
+        out = (SDL_Rect){ w - (rect->x + rect->w), h - (rect->y + rect->h), rect->w, rect->h };
+        break;
+    case 270:
+        out = (SDL_Rect){ rect->y, w - (rect->x + rect->w), rect->h, rect->w };
+        break;
+    default:
+        out = *rect;
+        break;
+    }
+    return out;
+}
+
+void ESPIDF_RotateTouchPoint(int *x, int *y)
+{
+    int px = *x;
+    int py = *y;
+    const esp_bsp_sdl_display_config_t *display_config = &ESPIDF_GetPrimaryPanel()->config;
+
+    // Touch controllers report in the panel's native orientation, undo the rotation of the content
+    switch (display_rotation) {
+    case 90:
+        *x = py;
+        *y = display_config->width - 1 - px;
+        break;
+    case 180:
+        *x = display_config->width - 1 - px;
+        *y = display_config->height - 1 - py;
+        break;
+    case 270:
+        *x = display_config->height - 1 - py;
+        *y = px;
+        break;
+    default:
+        break;
+    }
+}
+
+#endif /* SDL_VIDEO_DRIVER_PRIVATE */
@@ -0,0 +1,19 @@
+#ifndef SDL_espidfrotate_h_
+#define SDL_espidfrotate_h_
+
+#include "SDL_internal.h"
+
+// Pick the display rotation and set up the panel for it, called once from VideoInit after the BSP is up
+extern void ESPIDF_InitRotation(void);
+// Degrees clockwise the window content is turned on the panel: 0, 90, 180 or 270
+extern int ESPIDF_GetRotation(void);
+// Size of the display as the app sees it
+extern void ESPIDF_GetRotatedSize(int *w, int *h);
+extern SDL_DisplayOrientation ESPIDF_GetNaturalOrientation(void);
+extern SDL_DisplayOrientation ESPIDF_GetCurrentOrientation(void);
+// Map a rect of a w x h window onto the panel, for rotation done by the PPA
+extern SDL_Rect ESPIDF_RotateRect(const SDL_Rect *rect, int w, int h);
+// Map a panel pixel position reported by the touch controller into the window
+extern void ESPIDF_RotateTouchPoint(int *x, int *y);
+
+#endif /* SDL_espidfrotate_h_ */
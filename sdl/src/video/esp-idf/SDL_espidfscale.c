@@ -0,0 +1,431 @@
+#include "SDL_internal.h"
+
+#ifdef SDL_VIDEO_DRIVER_PRIVATE
+
+#include "video/SDL_sysvideo.h"
+#include "SDL_espidfscale.h"
+#include "SDL_espidfrotate.h"
+#include "SDL_espidfshared.h"
+#include "SDL_espidfwindow.h"
+#include "SDL3/SDL_esp-idf.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "SDL_espidfscale";
+
+// Largest PPA scale, 15 and 15/16
+#define ESPIDF_SCALE_MAX 255
+
+/*
+ * With a logical presentation on the window's renderer, the window keeps its
+ * size but its pixel size, and so its surface, becomes the logical size. The
+ * renderer draws 1:1 and the PPA scales every chunk on its way to the panel.
+ * Scales are stored in 1/16 steps so window and display coordinates convert
+ * exactly. Other targets replicate pixels in the flush, which only takes over
+ * presentations that a whole factor up to ESPIDF_CPU_SCALE_MAX shows exactly
+ * as the renderer would, the renderer scales the rest into a surface of the
+ * window size. Zero-copy builds send the surface as it is and do not scale at
+ * all. The presentation is kept per window in its SDL_WindowData.
+ */
+
+#if defined(CONFIG_IDF_TARGET_ESP32P4) || !defined(CONFIG_SDL_ESPIDF_ZERO_COPY)
+/*
+ * Dynamic resolution: while frames take longer than the frame budget, the
+ * window is rendered below its logical size and scaled up by the PPA or the
+ * flush, and it is stepped back up once the larger size is expected to fit.
+ * The renderer's logical presentation keeps app coordinates unchanged.
+ */
+// Presents the frame time is averaged over before the render size is adjusted
+#define ESPIDF_BUDGET_FRAMES 16
+#endif
+
+#ifdef CONFIG_IDF_TARGET_ESP32P4
+static int manual_scale16 = ESPIDF_SCALE_ONE;
+
+void set_scale_factor(int factor, float factor_float)
+{
+    // Only used while the renderer has no logical presentation
+    manual_scale16 = SDL_clamp((int)(factor_float * ESPIDF_SCALE_ONE), 1, ESPIDF_SCALE_MAX);
+}
+#endif
+
+#if defined(CONFIG_IDF_TARGET_ESP32P4) || !defined(CONFIG_SDL_ESPIDF_ZERO_COPY)
+// Size a logical size is rendered at when divided by div16
+static int ESPIDF_RenderDivSize(int size, int div16)
+{
+    return SDL_max(size * ESPIDF_SCALE_ONE / div16, 1);
+}
+
+// Size a logical size is rendered at under the window's current frame budget
+static int ESPIDF_RenderSize(const SDL_WindowData *data, int size)
+{
+    return ESPIDF_RenderDivSize(size, data->render_div16);
+}
+
+#ifndef CONFIG_IDF_TARGET_ESP32P4
+// Whole factors that show a w x h surface on the display the way the renderer presents it in mode,
+// false if none up to ESPIDF_CPU_SCALE_MAX do
+static bool ESPIDF_GetWholeScale(SDL_RendererLogicalPresentation mode, int w, int h, int *fx, int *fy)
+{
+    int dw, dh;
+
+    ESPIDF_GetRotatedSize(&dw, &dh);
+    *fx = dw / w;
+    *fy = dh / h;
+    switch (mode) {
+    case SDL_LOGICAL_PRESENTATION_STRETCH:
+        if (dw % w != 0 || dh % h != 0) {
+            return false;
+        }
+        break;
+    case SDL_LOGICAL_PRESENTATION_INTEGER_SCALE:
+        *fx = *fy = SDL_min(*fx, *fy);
+        break;
+    case SDL_LOGICAL_PRESENTATION_LETTERBOX:
+        // The fitting scale is whole when one side fills the display exactly
+        *fx = *fy = SDL_min(*fx, *fy);
+        if (w * *fx != dw && h * *fy != dh) {
+            return false;
+        }
+        break;
+    case SDL_LOGICAL_PRESENTATION_OVERSCAN:
+        // The flush cannot crop, only an exact fit on both sides looks the same
+        *fx = *fy = SDL_min(*fx, *fy);
+        if (w * *fx != dw || h * *fy != dh) {
+            return false;
+        }
+        break;
+    default:
+        return false;
+    }
+    return *fx >= 1 && *fx <= ESPIDF_CPU_SCALE_MAX && *fy >= 1 && *fy <= ESPIDF_CPU_SCALE_MAX;
+}
+#endif
+
+// Logical presentation the driver scales itself, DISABLED when there is none or the renderer has to scale it
+static SDL_RendererLogicalPresentation ESPIDF_GetLogicalPresentation(SDL_Window *window, int *w, int *h)
+{
+    SDL_RendererLogicalPresentation mode = SDL_LOGICAL_PRESENTATION_DISABLED;
+    SDL_Renderer *renderer = SDL_GetRenderer(window);
+
+    *w = 0;
+    *h = 0;
+    if (!renderer || !SDL_GetRenderLogicalPresentation(renderer, w, h, &mode) || *w <= 0 || *h <= 0) {
+        return SDL_LOGICAL_PRESENTATION_DISABLED;
+    }
+#ifndef CONFIG_IDF_TARGET_ESP32P4
+    int fx, fy;
+    if (!ESPIDF_GetWholeScale(mode, *w, *h, &fx, &fy)) {
+        // Fractional, too large or larger than the display, the renderer scales into the window size
+        return SDL_LOGICAL_PRESENTATION_DISABLED;
+    }
+#endif
+    return mode;
+}
+#endif
+
+void ESPIDF_InitPresentation(SDL_WindowData *data)
+{
+    data->present_mode = SDL_LOGICAL_PRESENTATION_DISABLED;
+    data->scale_x16 = ESPIDF_SCALE_ONE;
+    data->scale_y16 = ESPIDF_SCALE_ONE;
+    data->render_div16 = ESPIDF_SCALE_ONE;
+}
+
+void ESPIDF_UpdatePresentation(SDL_Window *window, int w, int h)
+{
+    SDL_WindowData *data = window->internal;
+    int scale_x16 = ESPIDF_SCALE_ONE;
+    int scale_y16 = ESPIDF_SCALE_ONE;
+    SDL_RendererLogicalPresentation present_mode = SDL_LOGICAL_PRESENTATION_DISABLED;
+    SDL_Rect present_rect;
+    int dw, dh;
+
+    ESPIDF_GetRotatedSize(&dw, &dh);
+
+#ifdef CONFIG_IDF_TARGET_ESP32P4
+    int lw, lh;
+    int fit_x16 = dw * ESPIDF_SCALE_ONE / w;
+    int fit_y16 = dh * ESPIDF_SCALE_ONE / h;
+
+    present_mode = ESPIDF_GetLogicalPresentation(window, &lw, &lh);
+    switch (present_mode) {
+    case SDL_LOGICAL_PRESENTATION_STRETCH:
+        scale_x16 = fit_x16;
+        scale_y16 = fit_y16;
+        break;
+    case SDL_LOGICAL_PRESENTATION_INTEGER_SCALE:
+        scale_x16 = SDL_min(fit_x16, fit_y16) / ESPIDF_SCALE_ONE * ESPIDF_SCALE_ONE;
+        if (scale_x16 == 0) {
+            // Larger than the display, shrink to fit like letterbox does
+            scale_x16 = SDL_min(fit_x16, fit_y16);
+        }
+        scale_y16 = scale_x16;
+        break;
+    case SDL_LOGICAL_PRESENTATION_LETTERBOX:
+    case SDL_LOGICAL_PRESENTATION_OVERSCAN:
+        // The PPA cannot crop its output, overscan is shown letterboxed
+        scale_x16 = SDL_min(fit_x16, fit_y16);
+        scale_y16 = scale_x16;
+        break;
+    default:
+        scale_x16 = manual_scale16;
+        scale_y16 = manual_scale16;
+        break;
+    }
+    scale_x16 = SDL_clamp(scale_x16, 1, ESPIDF_SCALE_MAX);
+    scale_y16 = SDL_clamp(scale_y16, 1, ESPIDF_SCALE_MAX);
+#elif !defined(CONFIG_SDL_ESPIDF_ZERO_COPY)
+    int lw, lh, fx, fy;
+
+    present_mode = ESPIDF_GetLogicalPresentation(window, &lw, &lh);
+    if (present_mode != SDL_LOGICAL_PRESENTATION_DISABLED) {
+        if (ESPIDF_GetWholeScale(present_mode, w, h, &fx, &fy)) {
+            scale_x16 = fx * ESPIDF_SCALE_ONE;
+            scale_y16 = fy * ESPIDF_SCALE_ONE;
+        } else {
+            // Only the logical size was checked, a surface of another size is shown as it is
+            present_mode = SDL_LOGICAL_PRESENTATION_DISABLED;
+        }
+    }
+#endif
+
+    present_rect.w = w * scale_x16 / ESPIDF_SCALE_ONE;
+    present_rect.h = h * scale_y16 / ESPIDF_SCALE_ONE;
+    if (present_mode == SDL_LOGICAL_PRESENTATION_DISABLED) {
+        // Unscaled windows sit at their window position, see ESPIDF_PlaceWindow
+        present_rect.x = SDL_clamp(data->x, 0, SDL_max(dw - present_rect.w, 0));
+        present_rect.y = SDL_clamp(data->y, 0, SDL_max(dh - present_rect.h, 0));
+    } else {
+        present_rect.x = (dw - present_rect.w) / 2;
+        present_rect.y = (dh - present_rect.h) / 2;
+    }
+
+    data->present_w = w;
+    data->present_h = h;
+    data->present_mode = present_mode;
+    data->scale_x16 = scale_x16;
+    data->scale_y16 = scale_y16;
+    data->present_rect = present_rect;
+
+    // Apps lay out their HUD for the size the window is really rendered at
+    SDL_PropertiesID props = SDL_GetWindowProperties(window);
+    SDL_SetNumberProperty(props, SDL_PROP_WINDOW_ESPIDF_RENDER_WIDTH_NUMBER, w);
+    SDL_SetNumberProperty(props, SDL_PROP_WINDOW_ESPIDF_RENDER_HEIGHT_NUMBER, h);
+#if defined(CONFIG_IDF_TARGET_ESP32P4) || !defined(CONFIG_SDL_ESPIDF_ZERO_COPY)
+    // Frames at the old size say nothing about the new one
+    data->budget_present_end = 0;
+    data->budget_sum = 0;
+    data->budget_frames = 0;
+#endif
+
+    if (ESPIDF_IsScaled(data)) {
+        ESP_LOGI(TAG, "Window %dx%d scaled by %d/16 x %d/16 to %dx%d at %d,%d", w, h, scale_x16, scale_y16,
+                 present_rect.w, present_rect.h, present_rect.x, present_rect.y);
+    }
+}
+
+#if defined(CONFIG_IDF_TARGET_ESP32P4) || !defined(CONFIG_SDL_ESPIDF_ZERO_COPY)
+// Largest logical size over render size the presentation can still scale up to cover the same area
+static int ESPIDF_MaxRenderDiv16(SDL_Window *window)
+{
+    SDL_RendererLogicalPresentation mode;
+    int lw, lh;
+
+    mode = ESPIDF_GetLogicalPresentation(window, &lw, &lh);
+    if (mode == SDL_LOGICAL_PRESENTATION_DISABLED) {
+        return ESPIDF_SCALE_ONE;
+    }
+#ifdef CONFIG_IDF_TARGET_ESP32P4
+    return 2 * ESPIDF_SCALE_ONE;
+#else
+    // Pixels are only replicated by whole factors, so the logical size is divided by whole factors too. The render
+    // size steps through every divisor up to the largest one, each must still scale up exactly.
+    int fx, fy;
+    int div = ESPIDF_SCALE_ONE;
+
+    while (div < ESPIDF_CPU_SCALE_MAX * ESPIDF_SCALE_ONE) {
+        int next = div + ESPIDF_SCALE_ONE;
+        if (!ESPIDF_GetWholeScale(mode, ESPIDF_RenderDivSize(lw, next), ESPIDF_RenderDivSize(lh, next), &fx, &fy)) {
+            break;
+        }
+        div = next;
+    }
+    return div;
+#endif
+}
+
+// Step between render sizes, whole factors where the presentation only scales by those
+static int ESPIDF_RenderDivStep(const SDL_WindowData *data)
+{
+#ifdef CONFIG_IDF_TARGET_ESP32P4
+    return (data->present_mode == SDL_LOGICAL_PRESENTATION_INTEGER_SCALE) ? ESPIDF_SCALE_ONE : 2;
+#else
+    return ESPIDF_SCALE_ONE;
+#endif
+}
+#endif
+
+void ESPIDF_GetWindowSizeInPixels(SDL_VideoDevice *_this, SDL_Window *window, int *w, int *h)
+{
+    *w = window->w;
+    *h = window->h;
+#if defined(CONFIG_IDF_TARGET_ESP32P4) || !defined(CONFIG_SDL_ESPIDF_ZERO_COPY)
+    const SDL_WindowData *data = window->internal;
+    int lw, lh;
+
+    if (data && data->display->primary && ESPIDF_GetLogicalPresentation(window, &lw, &lh) != SDL_LOGICAL_PRESENTATION_DISABLED) {
+        // The window keeps its size, its surface is rendered at the logical size or below and scaled up in the flush.
+        // Presentations the driver cannot reproduce keep the window size, so the renderer scales them.
+        *w = ESPIDF_RenderSize(data, lw);
+        *h = ESPIDF_RenderSize(data, lh);
+    }
+#endif
+}
+
+bool ESPIDF_FollowLogicalPresentation(SDL_Window *window)
+{
+#if defined(CONFIG_IDF_TARGET_ESP32P4) || !defined(CONFIG_SDL_ESPIDF_ZERO_COPY)
+    SDL_WindowData *data = window->internal;
+    int lw, lh, pw, ph;
+    SDL_RendererLogicalPresentation mode = ESPIDF_GetLogicalPresentation(window, &lw, &lh);
+
+    // A new logical size or mode may not allow the current render size
+    data->render_div16 = SDL_min(data->render_div16, ESPIDF_MaxRenderDiv16(window));
+    SDL_GetWindowSizeInPixels(window, &pw, &ph);
+    if (pw != data->present_w || ph != data->present_h) {
+        // SDL recreates the framebuffer at the new pixel size before the next frame is drawn
+        SDL_CheckWindowPixelSizeChanged(window);
+        return false;
+    }
+    if (mode != data->present_mode) {
+        ESPIDF_UpdatePresentation(window, data->present_w, data->present_h);
+        return true;
+    }
+#endif
+    return false;
+}
+
+void ESPIDF_TrackFrameBudget(SDL_Window *window, int64_t paced_us)
+{
+#if defined(CONFIG_IDF_TARGET_ESP32P4) || !defined(CONFIG_SDL_ESPIDF_ZERO_COPY)
+    SDL_WindowData *data = window->internal;
+    int64_t now = esp_timer_get_time();
+    // Render and flush time since the last present returned, without the vsync wait
+    int64_t frame_us = SDL_max(now - data->budget_present_end - paced_us, 0);
+    bool first = (data->budget_present_end == 0);
+
+    data->budget_present_end = now;
+    if (first || data->present_mode == SDL_LOGICAL_PRESENTATION_DISABLED) {
+        return;
+    }
+    data->budget_sum += frame_us;
+    if (++data->budget_frames < ESPIDF_BUDGET_FRAMES) {
+        return;
+    }
+
+    int64_t avg = data->budget_sum / data->budget_frames;
+    data->budget_sum = 0;
+    data->budget_frames = 0;
+
+    const char *hint = SDL_GetHint(SDL_HINT_ESPIDF_FRAME_BUDGET_US);
+    int budget = hint ? SDL_atoi(hint) : CONFIG_SDL_ESPIDF_FRAME_BUDGET_US;
+    int step = ESPIDF_RenderDivStep(data);
+    int div = data->render_div16;
+
+    if (budget <= 0) {
+        div = ESPIDF_SCALE_ONE;
+    } else if (avg > budget) {
+        div = SDL_min(div + step, ESPIDF_MaxRenderDiv16(window));
+    } else if (div > ESPIDF_SCALE_ONE) {
+        // Step up once the frame is expected to fit with some margin, assuming the time grows with the area
+        int next = SDL_max(div - step, ESPIDF_SCALE_ONE);
+        if (avg * div * div / (next * next) < (int64_t)budget * 7 / 8) {
+            div = next;
+        }
+    }
+    // Whole factors stay whole after a mode change
+    div = SDL_max(div / step * step, ESPIDF_SCALE_ONE);
+
+    if (div != data->render_div16) {
+        ESP_LOGI(TAG, "Frame time %d us against a budget of %d us, rendering at %d/16 of the logical size",
+                 (int)avg, budget, ESPIDF_SCALE_ONE * ESPIDF_SCALE_ONE / div);
+        data->render_div16 = div;
+    }
+#endif
+}
+
+bool ESPIDF_IsScaled(const SDL_WindowData *data)
+{
+    return data->scale_x16 != ESPIDF_SCALE_ONE || data->scale_y16 != ESPIDF_SCALE_ONE;
+}
+
+int ESPIDF_GetScaleX16(const SDL_WindowData *data)
+{
+    return data->scale_x16;
+}
+
+int ESPIDF_GetScaleY16(const SDL_WindowData *data)
+{
+    return data->scale_y16;
+}
+
+SDL_Rect ESPIDF_GetPresentationRect(const SDL_WindowData *data)
+{
+    return data->present_rect;
+}
+
+SDL_Rect ESPIDF_ScaleRect(const SDL_WindowData *data, const SDL_Rect *rect)
+{
+    int x0 = rect->x * data->scale_x16 / ESPIDF_SCALE_ONE;
+    int y0 = rect->y * data->scale_y16 / ESPIDF_SCALE_ONE;
+    int x1 = (rect->x + rect->w) * data->scale_x16 / ESPIDF_SCALE_ONE;
+    int y1 = (rect->y + rect->h) * data->scale_y16 / ESPIDF_SCALE_ONE;
+
+    return (SDL_Rect){ data->present_rect.x + x0, data->present_rect.y + y0, x1 - x0, y1 - y0 };
+}
+
+// Smallest step of window pixels that spans a whole number of display pixels
+static int ESPIDF_ScaleAlignment(int scale16)
+{
+    int step = ESPIDF_SCALE_ONE;
+
+    while (step > 1 && (scale16 * (step / 2)) % ESPIDF_SCALE_ONE == 0) {
+        step /= 2;
+    }
+    return step;
+}
+
+int ESPIDF_ScaleAlignmentY(const SDL_WindowData *data)
+{
+    return ESPIDF_ScaleAlignment(data->scale_y16);
+}
+
+void ESPIDF_AlignRectToScale(const SDL_WindowData *data, SDL_Rect *rect, int w, int h)
+{
+    int ax = ESPIDF_ScaleAlignment(data->scale_x16);
+    int ay = ESPIDF_ScaleAlignment(data->scale_y16);
+    int x0 = rect->x / ax * ax;
+    int y0 = rect->y / ay * ay;
+    int x1 = SDL_min((rect->x + rect->w + ax - 1) / ax * ax, w);
+    int y1 = SDL_min((rect->y + rect->h + ay - 1) / ay * ay, h);
+
+    *rect = (SDL_Rect){ x0, y0, x1 - x0, y1 - y0 };
+}
+
+void ESPIDF_UnscalePoint(const SDL_Window *window, int *x, int *y)
+{
+    const SDL_WindowData *data = window ? window->internal : NULL;
+
+    if (!data || data->present_w <= 0 || data->present_h <= 0) {
+        return;
+    }
+    // Touches on the letterbox bars stick to the nearest window edge
+    int sx = SDL_clamp((*x - data->present_rect.x) * ESPIDF_SCALE_ONE / data->scale_x16, 0, data->present_w - 1);
+    int sy = SDL_clamp((*y - data->present_rect.y) * ESPIDF_SCALE_ONE / data->scale_y16, 0, data->present_h - 1);
+    // The surface may be rendered smaller than the window it stands for
+    *x = sx * window->w / data->present_w;
+    *y = sy * window->h / data->present_h;
+}
+
+#endif /* SDL_VIDEO_DRIVER_PRIVATE */
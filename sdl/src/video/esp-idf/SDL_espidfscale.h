@@ -0,0 +1,36 @@
+#ifndef SDL_espidfscale_h_
+#define SDL_espidfscale_h_
+
+#include "SDL_internal.h"
+
+// Scales are kept in 1/16 steps, the precision of the PPA scaler
+#define ESPIDF_SCALE_ONE 16
+
+// Without a PPA the flush replicates pixels while converting, by whole factors up to this one
+#define ESPIDF_CPU_SCALE_MAX 3
+
+// A new window starts out unscaled
+extern void ESPIDF_InitPresentation(SDL_WindowData *data);
+// Work out where a w x h window surface goes on the display, from the renderer's logical presentation
+extern void ESPIDF_UpdatePresentation(SDL_Window *window, int w, int h);
+// Pixel size of the window: the render size while the flush scales a logical presentation up to the window
+extern void ESPIDF_GetWindowSizeInPixels(SDL_VideoDevice *_this, SDL_Window *window, int *w, int *h);
+// Track SDL_SetRenderLogicalPresentation, returns true when the scaling changed for the current surface
+extern bool ESPIDF_FollowLogicalPresentation(SDL_Window *window);
+// Called when a present returns, with the time it waited for vsync. Lowers the render size below the
+// logical size while rendering and flushing run over the frame budget.
+extern void ESPIDF_TrackFrameBudget(SDL_Window *window, int64_t paced_us);
+extern bool ESPIDF_IsScaled(const SDL_WindowData *data);
+extern int ESPIDF_GetScaleX16(const SDL_WindowData *data);
+extern int ESPIDF_GetScaleY16(const SDL_WindowData *data);
+// Area of the rotated display the window covers
+extern SDL_Rect ESPIDF_GetPresentationRect(const SDL_WindowData *data);
+// Map a window rect onto the rotated display
+extern SDL_Rect ESPIDF_ScaleRect(const SDL_WindowData *data, const SDL_Rect *rect);
+// Grow a window rect to edges that land on whole display pixels, clipped to the w x h window
+extern void ESPIDF_AlignRectToScale(const SDL_WindowData *data, SDL_Rect *rect, int w, int h);
+extern int ESPIDF_ScaleAlignmentY(const SDL_WindowData *data);
+// Map a position on the rotated display into the window, window may be NULL
+extern void ESPIDF_UnscalePoint(const SDL_Window *window, int *x, int *y);
+
+#endif /* SDL_espidfscale_h_ */
@@ -1,15 +1,41 @@
 #ifndef SDL_espidfshared_h_
 #define SDL_espidfshared_h_
 
+#include "video/SDL_sysvideo.h"
 #include "esp_lcd_panel_io.h"
 #include "esp_lcd_panel_ops.h"
 #include "esp_bsp_sdl.h"
 
-// Shared handles
-extern esp_lcd_panel_handle_t panel_handle;
-extern esp_lcd_panel_io_handle_t panel_io_handle;
+// How pixels reach the panel, decides which flush strategies make sense
+typedef enum {
+    ESPIDF_PANEL_IO,   // SPI/i80 panel fed through panel_io_handle transactions
+    ESPIDF_PANEL_RGB,  // RGB panel scanning out of its own frame buffer
+    ESPIDF_PANEL_DPI,  // MIPI-DSI panel (ESP32-P4)
+} ESPIDF_PanelInterface;
 
-extern esp_bsp_sdl_display_config_t display_config;
+// One panel, reported to SDL as one display
+struct SDL_DisplayData
+{
+    esp_lcd_panel_handle_t panel_handle;
+    esp_lcd_panel_io_handle_t panel_io_handle;  // NULL for RGB and MIPI-DSI panels
+    esp_bsp_sdl_display_config_t config;
+    ESPIDF_PanelInterface panel_interface;
+    // The BSP panel, rotation, touch, vsync, page flips and async present only work on it
+    bool primary;
+    int index;  // 0 for the BSP panel, registered panels follow in the order they were registered
+    SDL_Window *window;  // Window whose framebuffer the panel shows, NULL if none
+    // No RGB565 byte swap needed: frame buffer and 18/24-bit panels, or panels the board switched over
+    bool cpu_byte_order;
+};
+
+// Bytes per pixel on the panel bus, 3 for 18/24-bit panels (RGB24 or BGR24) and 2 for RGB565 panels
+static inline int ESPIDF_PanelBytesPerPixel(const SDL_DisplayData *display)
+{
+    return (SDL_BYTESPERPIXEL(display->config.pixel_format) == 3) ? 3 : 2;
+}
+
+// The BSP panel, NULL while the video subsystem is not initialized
+extern SDL_DisplayData *ESPIDF_GetPrimaryPanel(void);
 
 #ifdef ESP_BSP_SDL_TOUCH_SUPPORT
 extern esp_lcd_touch_handle_t touch_handle;
@@ -0,0 +1,83 @@
+#include "SDL_internal.h"
+
+#ifdef SDL_VIDEO_DRIVER_PRIVATE
+
+#include "SDL_espidfstats.h"
+#include "SDL3/SDL_esp-idf.h"
+
+#ifdef CONFIG_SDL_ESPIDF_PRESENT_STATS
+
+// Window property names per stage: min, avg, p99
+static const char *const stage_props[ESPIDF_STAGE_COUNT][3] = {
+    { SDL_PROP_WINDOW_ESPIDF_STATS_LOOKUP_MIN_NUMBER, SDL_PROP_WINDOW_ESPIDF_STATS_LOOKUP_AVG_NUMBER, SDL_PROP_WINDOW_ESPIDF_STATS_LOOKUP_P99_NUMBER },
+    { SDL_PROP_WINDOW_ESPIDF_STATS_CONVERT_MIN_NUMBER, SDL_PROP_WINDOW_ESPIDF_STATS_CONVERT_AVG_NUMBER, SDL_PROP_WINDOW_ESPIDF_STATS_CONVERT_P99_NUMBER },
+    { SDL_PROP_WINDOW_ESPIDF_STATS_PPA_MIN_NUMBER, SDL_PROP_WINDOW_ESPIDF_STATS_PPA_AVG_NUMBER, SDL_PROP_WINDOW_ESPIDF_STATS_PPA_P99_NUMBER },
+    { SDL_PROP_WINDOW_ESPIDF_STATS_WAIT_MIN_NUMBER, SDL_PROP_WINDOW_ESPIDF_STATS_WAIT_AVG_NUMBER, SDL_PROP_WINDOW_ESPIDF_STATS_WAIT_P99_NUMBER },
+    { SDL_PROP_WINDOW_ESPIDF_STATS_TOTAL_MIN_NUMBER, SDL_PROP_WINDOW_ESPIDF_STATS_TOTAL_AVG_NUMBER, SDL_PROP_WINDOW_ESPIDF_STATS_TOTAL_P99_NUMBER },
+};
+
+void ESPIDF_ResetPresentStats(ESPIDF_PresentStats *stats, SDL_PropertiesID props)
+{
+    SDL_zerop(stats);
+    stats->props = props;
+}
+
+void ESPIDF_BeginFrameStats(ESPIDF_PresentStats *stats)
+{
+    SDL_zeroa(stats->frame_us);
+    stats->frame_start = esp_timer_get_time();
+}
+
+static void ESPIDF_PublishStats(ESPIDF_PresentStats *stats)
+{
+    uint32_t sorted[ESPIDF_STATS_FRAMES];
+    int n = stats->num_samples;
+    int p99 = (n * 99 + 99) / 100 - 1;  // Nearest rank
+
+    for (int stage = 0; stage < ESPIDF_STAGE_COUNT; stage++) {
+        Uint64 sum = 0;
+
+        // Insertion sort, the window is small and only sorted every few presents
+        for (int i = 0; i < n; i++) {
+            uint32_t v = stats->samples[stage][i];
+            int j = i;
+
+            sum += v;
+            while (j > 0 && sorted[j - 1] > v) {
+                sorted[j] = sorted[j - 1];
+                j--;
+            }
+            sorted[j] = v;
+        }
+        SDL_SetNumberProperty(stats->props, stage_props[stage][0], sorted[0]);
+        SDL_SetNumberProperty(stats->props, stage_props[stage][1], (Sint64)(sum / n));
+        SDL_SetNumberProperty(stats->props, stage_props[stage][2], sorted[p99]);
+    }
+    SDL_SetNumberProperty(stats->props, SDL_PROP_WINDOW_ESPIDF_STATS_FRAMES_NUMBER, (Sint64)stats->frames);
+    SDL_SetNumberProperty(stats->props, SDL_PROP_WINDOW_ESPIDF_STATS_BYTES_NUMBER, (Sint64)stats->bytes);
+    SDL_SetNumberProperty(stats->props, SDL_PROP_WINDOW_ESPIDF_STATS_CHUNKS_NUMBER, (Sint64)stats->chunks);
+}
+
+void ESPIDF_EndFrameStats(ESPIDF_PresentStats *stats)
+{
+    uint32_t lookup_us = stats->lookup_us;
+
+    stats->lookup_us = 0;
+    stats->frame_us[ESPIDF_STAGE_LOOKUP] += lookup_us;
+    stats->frame_us[ESPIDF_STAGE_TOTAL] = (uint32_t)(esp_timer_get_time() - stats->frame_start) + lookup_us;
+
+    for (int stage = 0; stage < ESPIDF_STAGE_COUNT; stage++) {
+        stats->samples[stage][stats->next_sample] = stats->frame_us[stage];
+    }
+    stats->next_sample = (stats->next_sample + 1) % ESPIDF_STATS_FRAMES;
+    stats->num_samples = SDL_min(stats->num_samples + 1, ESPIDF_STATS_FRAMES);
+    stats->frames++;
+
+    if (stats->frames % ESPIDF_STATS_PUBLISH_INTERVAL == 0) {
+        ESPIDF_PublishStats(stats);
+    }
+}
+
+#endif /* CONFIG_SDL_ESPIDF_PRESENT_STATS */
+
+#endif /* SDL_VIDEO_DRIVER_PRIVATE */
@@ -0,0 +1,69 @@
+#ifndef SDL_espidfstats_h_
+#define SDL_espidfstats_h_
+
+#include "SDL_internal.h"
+#include "esp_timer.h"
+
+// Stages of a present the flush is timed in
+typedef enum {
+    ESPIDF_STAGE_LOOKUP,   // Finding the window surface
+    ESPIDF_STAGE_CONVERT,  // RGB565 byte swap or LUT expansion into the chunk ring
+    ESPIDF_STAGE_PPA,      // PPA scaling, rotation and conversion
+    ESPIDF_STAGE_WAIT,     // Waiting for free chunk slots and sent chunks
+    ESPIDF_STAGE_TOTAL,
+    ESPIDF_STAGE_COUNT
+} ESPIDF_Stage;
+
+// Presents the rolling min/avg/p99 are taken over
+#define ESPIDF_STATS_FRAMES 64
+// Presents between two updates of the window properties
+#define ESPIDF_STATS_PUBLISH_INTERVAL 16
+
+typedef struct ESPIDF_PresentStats
+{
+    SDL_PropertiesID props;  // Window properties the statistics are published to
+    int64_t frame_start;
+    uint32_t frame_us[ESPIDF_STAGE_COUNT];  // Stage times of the present being flushed
+    volatile uint32_t lookup_us;            // Surface lookup of the last present, taken by the next flush
+    uint32_t samples[ESPIDF_STAGE_COUNT][ESPIDF_STATS_FRAMES];
+    int num_samples;
+    int next_sample;
+    Uint64 frames;
+    Uint64 bytes;
+    Uint64 chunks;
+} ESPIDF_PresentStats;
+
+#ifdef CONFIG_SDL_ESPIDF_PRESENT_STATS
+extern void ESPIDF_ResetPresentStats(ESPIDF_PresentStats *stats, SDL_PropertiesID props);
+extern void ESPIDF_BeginFrameStats(ESPIDF_PresentStats *stats);
+extern void ESPIDF_EndFrameStats(ESPIDF_PresentStats *stats);
+
+static inline void ESPIDF_AddStageTime(ESPIDF_PresentStats *stats, ESPIDF_Stage stage, int64_t start)
+{
+    stats->frame_us[stage] += (uint32_t)(esp_timer_get_time() - start);
+}
+
+static inline void ESPIDF_CountChunk(ESPIDF_PresentStats *stats, int w, int h, int bytes_per_pixel)
+{
+    // Counted in the panel format whatever the window format
+    stats->bytes += (Uint64)w * h * bytes_per_pixel;
+    stats->chunks++;
+}
+
+// Stage timing compiles out with the statistics
+#define ESPIDF_STATS_START(start)              int64_t start = esp_timer_get_time()
+#define ESPIDF_STATS_STAGE(data, stage, start) ESPIDF_AddStageTime(&(data)->stats, stage, start)
+#define ESPIDF_STATS_CHUNK(data, w, h)         ESPIDF_CountChunk(&(data)->stats, w, h, ESPIDF_PanelBytesPerPixel((data)->display))
+#define ESPIDF_STATS_LOOKUP(data, start)       ((data)->stats.lookup_us = (uint32_t)(esp_timer_get_time() - (start)))
+#define ESPIDF_STATS_BEGIN_FRAME(data)         ESPIDF_BeginFrameStats(&(data)->stats)
+#define ESPIDF_STATS_END_FRAME(data)           ESPIDF_EndFrameStats(&(data)->stats)
+#else
+#define ESPIDF_STATS_START(start)
+#define ESPIDF_STATS_STAGE(data, stage, start)
+#define ESPIDF_STATS_CHUNK(data, w, h)
+#define ESPIDF_STATS_LOOKUP(data, start)
+#define ESPIDF_STATS_BEGIN_FRAME(data)
+#define ESPIDF_STATS_END_FRAME(data)
+#endif
+
+#endif /* SDL_espidfstats_h_ */
@@ -4,6 +4,8 @@
 #include <stdbool.h>
 
 #include "SDL_espidfshared.h"
+#include "SDL_espidfrotate.h"
+#include "SDL_espidfscale.h"
 #include "esp_log.h"
 
 #define ESPIDF_TOUCH_ID         1
@@ -25,7 +27,8 @@ void ESPIDF_InitTouch(void)
 
 void ESPIDF_PumpTouchEvent(void)
 {
-    if (!display_config.has_touch) {
+    const SDL_DisplayData *panel = ESPIDF_GetPrimaryPanel();
+    if (!panel || !panel->config.has_touch) {
         return;
     }
     
@@ -42,20 +45,25 @@ void ESPIDF_PumpTouchEvent(void)
     display = NULL;
     window = display ? display->fullscreen_window : NULL;
 
+    int x = touch_info.x;
+    int y = touch_info.y;
+    ESPIDF_RotateTouchPoint(&x, &y);
+    ESPIDF_UnscalePoint(panel->window, &x, &y);
+
     if (touch_info.pressed != was_pressed) {
         was_pressed = touch_info.pressed;
-        ESP_LOGD("SDL", "touch state: %d, [%d, %d]", touch_info.pressed, touch_info.x, touch_info.y);
+        ESP_LOGD("SDL", "touch state: %d, [%d, %d]", touch_info.pressed, x, y);
         SDL_SendTouch(0, ESPIDF_TOUCH_ID, ESPIDF_TOUCH_FINGER,
                       window,
                       touch_info.pressed,
-                      touch_info.x,
-                      touch_info.y,
+                      x,
+                      y,
                       touch_info.pressed ? 1.0f : 0.0f);
     } else if (touch_info.pressed) {
         SDL_SendTouchMotion(0, ESPIDF_TOUCH_ID, ESPIDF_TOUCH_FINGER,
                             window,
-                            touch_info.x,
-                            touch_info.y,
+                            x,
+                            y,
                             1.0f);
     }
 }
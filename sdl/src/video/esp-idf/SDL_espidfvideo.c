@@ -5,6 +5,12 @@
 #include "SDL_espidfframebuffer.h"
 #include "SDL_espidfevents.h"
 #include "SDL_espidftouch.h"
+#include "SDL_espidfvsync.h"
+#include "SDL_espidfrotate.h"
+#include "SDL_espidfscale.h"
+#include "SDL_espidfwindow.h"
+#include "SDL_espidfbounce.h"
+#include "SDL3/SDL_esp-idf.h"
 
 #include "esp_log.h"
 
@@ -14,11 +20,21 @@
 #include "video/SDL_pixels_c.h"
 #include "events/SDL_events_c.h"
 
+static const char *TAG = "SDL_espidfvideo";
+
 #define ESPIDFVID_DRIVER_NAME "espidf"
 
-esp_lcd_panel_handle_t panel_handle = NULL;
-esp_lcd_panel_io_handle_t panel_io_handle = NULL;
-esp_bsp_sdl_display_config_t display_config;
+// ST7789 RAM control, the second parameter selects little endian RGB565 on top of the reset value
+#define ESPIDF_ST7789_RAMCTRL 0xB0
+#define ESPIDF_ST7789_RAMCTRL_LITTLE_ENDIAN 0xF8
+
+// Upper bound of panels, the BSP panel included
+#define ESPIDF_MAX_PANELS 4
+
+// Panels registered by the app before the video subsystem comes up
+static SDL_DisplayData extra_panels[ESPIDF_MAX_PANELS - 1];
+static int num_extra_panels = 0;
+static SDL_DisplayData *primary_panel = NULL;  // Owned by the SDL display
 
 static bool ESPIDF_VideoInit(SDL_VideoDevice *_this);
 static void ESPIDF_VideoQuit(SDL_VideoDevice *_this);
@@ -26,6 +42,8 @@ static void ESPIDF_VideoQuit(SDL_VideoDevice *_this);
 static bool ESPIDF_SetWindowPosition(SDL_VideoDevice *_this, SDL_Window *window)
 {
     SDL_SendWindowEvent(window, SDL_EVENT_WINDOW_MOVED, window->floating.x, window->floating.y);
+    // The surface keeps its size, it is only drawn somewhere else on the panel
+    ESPIDF_MoveWindowFramebuffer(window);
     return true;
 }
 
@@ -34,6 +52,118 @@ static void ESPIDF_SetWindowSize(SDL_VideoDevice *_this, SDL_Window *window)
     SDL_SendWindowEvent(window, SDL_EVENT_WINDOW_RESIZED, window->floating.w, window->floating.h);
 }
 
+__attribute__((weak)) esp_err_t esp_bsp_sdl_set_cpu_byte_order(esp_lcd_panel_handle_t panel, esp_lcd_panel_io_handle_t panel_io)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+__attribute__((weak)) bool esp_bsp_sdl_panel_is_st7789(esp_lcd_panel_handle_t panel, esp_lcd_panel_io_handle_t panel_io)
+{
+    return false;
+}
+
+/*
+ * RGB565 leaves the CPU little endian, SPI/i80 panels read it big endian.
+ * Frame buffer panels take it as it is. Other panels are switched over by the
+ * board or, for panels it declares as ST7789s, by the driver, otherwise the
+ * flush swaps the bytes.
+ */
+static void ESPIDF_DetectByteOrder(SDL_DisplayData *data)
+{
+    const char *hint = SDL_GetHint(SDL_HINT_ESPIDF_BYTE_ORDER);
+    const char *source = NULL;
+
+    // 18/24-bit panels take a byte stream, there is nothing to swap
+    data->cpu_byte_order = (data->panel_interface != ESPIDF_PANEL_IO || ESPIDF_PanelBytesPerPixel(data) == 3);
+    if (data->cpu_byte_order) {
+        return;
+    }
+
+    if (hint && SDL_strcasecmp(hint, "software") == 0) {
+        // Swapped on the CPU whatever the panel could do
+    } else if (hint && SDL_strcasecmp(hint, "hardware") == 0) {
+        source = "hint";
+    } else if (esp_bsp_sdl_set_cpu_byte_order(data->panel_handle, data->panel_io_handle) == ESP_OK) {
+        source = "board";
+#ifdef CONFIG_SDL_ESPIDF_ST7789_LITTLE_ENDIAN
+    } else if (esp_bsp_sdl_panel_is_st7789(data->panel_handle, data->panel_io_handle) &&
+               esp_lcd_panel_io_tx_param(data->panel_io_handle, ESPIDF_ST7789_RAMCTRL,
+                                         (uint8_t[]){ 0x00, ESPIDF_ST7789_RAMCTRL_LITTLE_ENDIAN }, 2) == ESP_OK) {
+        source = "ST7789 RAMCTRL";
+#endif
+    }
+
+    data->cpu_byte_order = (source != NULL);
+    if (source) {
+        ESP_LOGI(TAG, "Panel takes RGB565 in CPU byte order (%s), no byte swap while flushing", source);
+    } else {
+#ifdef CONFIG_SDL_ESPIDF_ZERO_COPY
+        ESP_LOGW(TAG, "Zero-copy needs a panel that takes RGB565 in CPU byte order, colors will be wrong");
+#else
+        ESP_LOGI(TAG, "Panel takes big endian RGB565, bytes are swapped while flushing");
+#endif
+    }
+}
+
+SDL_DisplayData *ESPIDF_GetPrimaryPanel(void)
+{
+    return primary_panel;
+}
+
+bool SDL_ESPIDF_RegisterPanel(esp_lcd_panel_handle_t panel, esp_lcd_panel_io_handle_t panel_io, int w, int h)
+{
+    if (!panel || w <= 0 || h <= 0) {
+        return SDL_InvalidParamError("panel");
+    }
+    if (primary_panel) {
+        return SDL_SetError("Panels must be registered before the video subsystem is initialized");
+    }
+    if (num_extra_panels == (int)SDL_arraysize(extra_panels)) {
+        return SDL_SetError("At most %d panels are supported", ESPIDF_MAX_PANELS);
+    }
+
+    SDL_DisplayData *data = &extra_panels[num_extra_panels++];
+    SDL_zerop(data);
+    data->index = num_extra_panels;
+    data->panel_handle = panel;
+    data->panel_io_handle = panel_io;
+    data->config.width = w;
+    data->config.height = h;
+    data->config.pixel_format = SDL_PIXELFORMAT_RGB565;
+    if (panel_io) {
+        data->panel_interface = ESPIDF_PANEL_IO;
+    } else {
+#ifdef CONFIG_IDF_TARGET_ESP32P4
+        data->panel_interface = ESPIDF_PANEL_DPI;
+#else
+        data->panel_interface = ESPIDF_PANEL_RGB;
+#endif
+    }
+    return true;
+}
+
+// The display takes over the panel data and frees it when it is removed.
+// Its mode reports the window format negotiated with the panel, not the panel bus format.
+static bool ESPIDF_AddPanelDisplay(SDL_DisplayData *data, int w, int h, SDL_DisplayOrientation natural, SDL_DisplayOrientation current)
+{
+    SDL_VideoDisplay display;
+
+    ESPIDF_DetectByteOrder(data);
+
+    SDL_zero(display);
+    display.desktop_mode.format = ESPIDF_NegotiatePanelFormat(data, w, h);
+    display.desktop_mode.w = w;
+    display.desktop_mode.h = h;
+    display.natural_orientation = natural;
+    display.current_orientation = current;
+    display.internal = data;
+    if (SDL_AddVideoDisplay(&display, false) == 0) {
+        SDL_free(data);
+        return false;
+    }
+    return true;
+}
+
 static SDL_VideoDevice *ESPIDF_CreateDevice(void)
 {
     SDL_VideoDevice *device = (SDL_VideoDevice *)SDL_calloc(1, sizeof(SDL_VideoDevice));
@@ -41,12 +171,17 @@ static SDL_VideoDevice *ESPIDF_CreateDevice(void)
 
     device->VideoInit = ESPIDF_VideoInit;
     device->VideoQuit = ESPIDF_VideoQuit;
+    device->CreateSDLWindow = ESPIDF_CreateWindow;
+    device->DestroyWindow = ESPIDF_DestroyWindow;
     device->SetWindowPosition = ESPIDF_SetWindowPosition;
     device->SetWindowSize = ESPIDF_SetWindowSize;
+    device->GetWindowSizeInPixels = ESPIDF_GetWindowSizeInPixels;
     device->PumpEvents = ESPIDF_PumpEvents;
     device->CreateWindowFramebuffer = SDL_ESPIDF_CreateWindowFramebuffer;
     device->UpdateWindowFramebuffer = SDL_ESPIDF_UpdateWindowFramebuffer;
     device->DestroyWindowFramebuffer = SDL_ESPIDF_DestroyWindowFramebuffer;
+    device->SetWindowFramebufferVSync = SDL_ESPIDF_SetWindowFramebufferVSync;
+    device->GetWindowFramebufferVSync = SDL_ESPIDF_GetWindowFramebufferVSync;
 
     return device;
 }
@@ -56,33 +191,76 @@ VideoBootStrap PRIVATE_bootstrap = {
     ESPIDF_CreateDevice, NULL, false
 };
 
+// Failure path of ESPIDF_VideoInit, the displays added so far free their panel data with the device.
+// The app registers its panels again before the next try.
+static bool ESPIDF_AbortVideoInit(void)
+{
+    ESPIDF_QuitBouncePresent();
+    primary_panel = NULL;
+    num_extra_panels = 0;
+    return false;
+}
+
 static bool ESPIDF_VideoInit(SDL_VideoDevice *_this)
 {
-    SDL_DisplayMode mode;
-    SDL_zero(mode);
-    
+    SDL_DisplayData *bsp = SDL_calloc(1, sizeof(*bsp));
+    int w, h;
+
+    if (!bsp) {
+        return ESPIDF_AbortVideoInit();
+    }
+
     // Initialize the ESP-BSP SDL abstraction layer
-    esp_err_t ret = esp_bsp_sdl_init(&display_config, &panel_handle, &panel_io_handle);
+    esp_err_t ret = esp_bsp_sdl_init(&bsp->config, &bsp->panel_handle, &bsp->panel_io_handle);
     if (ret != ESP_OK) {
         printf("Failed to initialize ESP-BSP SDL abstraction: %s\n", esp_err_to_name(ret));
-        return false;
+        SDL_free(bsp);
+        return ESPIDF_AbortVideoInit();
     }
     
     printf("ESP-IDF video init for board: %s\n", esp_bsp_sdl_get_board_name());
-    printf("Display resolution: %dx%d\n", display_config.width, display_config.height);
-    
-    mode.format = display_config.pixel_format;
-    mode.w = display_config.width;
-    mode.h = display_config.height;
+    printf("Display resolution: %dx%d\n", bsp->config.width, bsp->config.height);
+
+#if defined(CONFIG_IDF_TARGET_ESP32P4)
+    bsp->panel_interface = ESPIDF_PANEL_DPI;
+#elif defined(CONFIG_SDL_BSP_ESP32_S3_LCD_EV_BOARD)
+    bsp->panel_interface = ESPIDF_PANEL_RGB;
+#else
+    bsp->panel_interface = ESPIDF_PANEL_IO;
+#endif
+    bsp->primary = true;
+    primary_panel = bsp;
     
-    if (SDL_AddBasicVideoDisplay(&mode) == 0) {
-        return false;
+    // The panel is turned before the display is reported, so apps see the rotated size
+    ESPIDF_InitRotation();
+
+    ESPIDF_GetRotatedSize(&w, &h);
+    if (!ESPIDF_AddPanelDisplay(bsp, w, h, ESPIDF_GetNaturalOrientation(), ESPIDF_GetCurrentOrientation())) {
+        return ESPIDF_AbortVideoInit();
+    }
+
+    // An RGB panel without frame buffer needs its bounce buffers filled before anything is shown
+    ESPIDF_InitBouncePresent(bsp);
+
+    // Panels registered by the app follow as further displays, shown as they are
+    for (int i = 0; i < num_extra_panels; i++) {
+        SDL_DisplayData *data = SDL_malloc(sizeof(*data));
+        if (!data) {
+            return ESPIDF_AbortVideoInit();
+        }
+        *data = extra_panels[i];
+        w = data->config.width;
+        h = data->config.height;
+        SDL_DisplayOrientation orientation = (w >= h) ? SDL_ORIENTATION_LANDSCAPE : SDL_ORIENTATION_PORTRAIT;
+        if (!ESPIDF_AddPanelDisplay(data, w, h, orientation, orientation)) {
+            return ESPIDF_AbortVideoInit();
+        }
     }
 
     ESP_ERROR_CHECK(esp_bsp_sdl_backlight_on());
     ESP_ERROR_CHECK(esp_bsp_sdl_display_on_off(true));
 
-    if (display_config.has_touch) {
+    if (bsp->config.has_touch) {
         ESPIDF_InitTouch();
     }
     
@@ -91,7 +269,9 @@ static bool ESPIDF_VideoInit(SDL_VideoDevice *_this)
 
 static void ESPIDF_VideoQuit(SDL_VideoDevice *_this)
 {
-    // Clean up BSP resources if needed
+    // The displays free their panel data
+    ESPIDF_QuitBouncePresent();
+    primary_panel = NULL;
 }
 
 #endif /* SDL_VIDEO_DRIVER_PRIVATE */
@@ -0,0 +1,224 @@
+#include "SDL_internal.h"
+
+#ifdef SDL_VIDEO_DRIVER_PRIVATE
+
+#include "video/SDL_sysvideo.h"
+#include "SDL_espidfvsync.h"
+#include "SDL_espidfshared.h"
+#include "SDL_espidfwindow.h"
+#include "SDL3/SDL_esp-idf.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "driver/gpio.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "SDL_espidfvsync";
+
+// A refresh source that stays silent this long is treated as stopped
+#define ESPIDF_REFRESH_TIMEOUT_MS 100
+
+static SemaphoreHandle_t refresh_semaphore = NULL;  // Kept for the lifetime of the app, ISRs may look at it any time
+static volatile uint32_t refresh_count = 0;         // Panel refreshes started so far
+static int vsync_interval = 0;                      // As passed to SDL_SetWindowSurfaceVSync
+static bool vsync_paced = false;                    // last_shown_refresh is valid
+static uint32_t last_shown_refresh = 0;             // Refresh that showed the last paced frame
+static Uint64 missed_refreshes = 0;
+#if CONFIG_SDL_ESPIDF_TE_GPIO >= 0
+static bool te_isr_added = false;
+#endif
+#if CONFIG_SDL_ESPIDF_VSYNC_TIMER_HZ > 0
+static esp_timer_handle_t refresh_timer = NULL;
+#endif
+
+IRAM_ATTR bool ESPIDF_NotifyRefreshFromISR(void)
+{
+    BaseType_t need_yield = pdFALSE;
+
+    if (refresh_semaphore) {
+        refresh_count++;
+        xSemaphoreGiveFromISR(refresh_semaphore, &need_yield);
+    }
+    return need_yield == pdTRUE;
+}
+
+#if CONFIG_SDL_ESPIDF_TE_GPIO >= 0
+static IRAM_ATTR void ESPIDF_OnTearingEffect(void *arg)
+{
+    // The panel raises TE when it starts reading its GRAM for a new refresh
+    if (ESPIDF_NotifyRefreshFromISR()) {
+        portYIELD_FROM_ISR();
+    }
+}
+#endif
+
+#if CONFIG_SDL_ESPIDF_VSYNC_TIMER_HZ > 0
+static void ESPIDF_OnRefreshTimer(void *arg)
+{
+    if (refresh_semaphore) {
+        refresh_count++;
+        xSemaphoreGive(refresh_semaphore);
+    }
+}
+#endif
+
+bool ESPIDF_HasRefreshSource(void)
+{
+    if (ESPIDF_GetPrimaryPanel()->panel_interface != ESPIDF_PANEL_IO) {
+        return true;
+    }
+    return CONFIG_SDL_ESPIDF_TE_GPIO >= 0 || CONFIG_SDL_ESPIDF_VSYNC_TIMER_HZ > 0;
+}
+
+void ESPIDF_StartRefreshSource(void)
+{
+    if (!refresh_semaphore) {
+        refresh_semaphore = xSemaphoreCreateBinary();
+        if (!refresh_semaphore) {
+            ESP_LOGW(TAG, "Failed to create refresh semaphore, vsync disabled");
+            return;
+        }
+    }
+    vsync_paced = false;
+
+    if (ESPIDF_GetPrimaryPanel()->panel_interface != ESPIDF_PANEL_IO) {
+        // Refreshes come from the RGB/DSI panel callbacks registered with the framebuffer
+        return;
+    }
+
+#if CONFIG_SDL_ESPIDF_TE_GPIO >= 0
+    if (!te_isr_added) {
+        const gpio_config_t te_config = {
+            .pin_bit_mask = 1ULL << CONFIG_SDL_ESPIDF_TE_GPIO,
+            .mode = GPIO_MODE_INPUT,
+            .intr_type = GPIO_INTR_POSEDGE,
+        };
+        ESP_ERROR_CHECK(gpio_config(&te_config));
+        // The BSP or the app may have installed the shared GPIO ISR service already
+        esp_err_t ret = gpio_install_isr_service(0);
+        if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+            ESP_ERROR_CHECK(ret);
+        }
+        ESP_ERROR_CHECK(gpio_isr_handler_add(CONFIG_SDL_ESPIDF_TE_GPIO, ESPIDF_OnTearingEffect, NULL));
+        te_isr_added = true;
+        ESP_LOGI(TAG, "Refresh timing from TE on GPIO %d", CONFIG_SDL_ESPIDF_TE_GPIO);
+    }
+#elif CONFIG_SDL_ESPIDF_VSYNC_TIMER_HZ > 0
+    if (!refresh_timer) {
+        const esp_timer_create_args_t timer_args = {
+            .callback = ESPIDF_OnRefreshTimer,
+            .name = "sdl_vsync",
+            .skip_unhandled_events = true,
+        };
+        ESP_ERROR_CHECK(esp_timer_create(&timer_args, &refresh_timer));
+        ESP_ERROR_CHECK(esp_timer_start_periodic(refresh_timer, 1000000 / CONFIG_SDL_ESPIDF_VSYNC_TIMER_HZ));
+        ESP_LOGI(TAG, "No TE line, pacing with a %d Hz timer", CONFIG_SDL_ESPIDF_VSYNC_TIMER_HZ);
+    }
+#endif
+}
+
+void ESPIDF_StopRefreshSource(void)
+{
+#if CONFIG_SDL_ESPIDF_TE_GPIO >= 0
+    if (te_isr_added) {
+        gpio_isr_handler_remove(CONFIG_SDL_ESPIDF_TE_GPIO);
+        te_isr_added = false;
+    }
+#elif CONFIG_SDL_ESPIDF_VSYNC_TIMER_HZ > 0
+    if (refresh_timer) {
+        esp_timer_stop(refresh_timer);
+        esp_timer_delete(refresh_timer);
+        refresh_timer = NULL;
+    }
+#endif
+}
+
+uint32_t ESPIDF_GetRefreshCount(void)
+{
+    return refresh_count;
+}
+
+void ESPIDF_WaitForRefresh(uint32_t refresh)
+{
+    // Stale gives from earlier refreshes only cost an extra loop
+    while ((int32_t)(refresh_count - refresh) < 0) {
+        if (!refresh_semaphore || xSemaphoreTake(refresh_semaphore, pdMS_TO_TICKS(ESPIDF_REFRESH_TIMEOUT_MS)) != pdTRUE) {
+            ESP_LOGW(TAG, "No panel refresh for %d ms, not waiting", ESPIDF_REFRESH_TIMEOUT_MS);
+            return;
+        }
+    }
+}
+
+void ESPIDF_PaceFrame(int latency)
+{
+    if (vsync_interval == 0 || !refresh_semaphore || !ESPIDF_HasRefreshSource()) {
+        return;
+    }
+
+    int interval = SDL_abs(vsync_interval);
+    uint32_t now = refresh_count;
+    uint32_t start = now;
+
+    if (vsync_paced && (int32_t)(last_shown_refresh + interval - latency - now) > 0) {
+        // Early: hold the frame until its refresh is due
+        start = last_shown_refresh + interval - latency;
+    } else if (latency == 0 && (vsync_interval > 0 || !vsync_paced)) {
+        // Copies must start right after a refresh edge to stay ahead of scan-out, adaptive vsync
+        // (-1) sends a late frame at once instead
+        start = now + 1;
+    }
+
+    if (start != now) {
+        ESPIDF_WaitForRefresh(start);
+    }
+
+    uint32_t shown = start + latency;
+    if (vsync_paced && (int32_t)(shown - (last_shown_refresh + interval)) > 0) {
+        missed_refreshes += shown - (last_shown_refresh + interval);
+    }
+    last_shown_refresh = shown;
+    vsync_paced = true;
+}
+
+bool SDL_ESPIDF_SetWindowFramebufferVSync(SDL_VideoDevice *_this, SDL_Window *window, int vsync)
+{
+    if (vsync < -1) {
+        return SDL_InvalidParamError("vsync");
+    }
+    if (vsync != 0 && !ESPIDF_HasRefreshSource()) {
+        return SDL_Unsupported();
+    }
+    if (vsync != 0 && window->internal && !window->internal->display->primary) {
+        // Refreshes are only tracked for the primary panel
+        return SDL_Unsupported();
+    }
+
+    vsync_interval = vsync;
+    vsync_paced = false;
+    return true;
+}
+
+bool SDL_ESPIDF_GetWindowFramebufferVSync(SDL_VideoDevice *_this, SDL_Window *window, int *vsync)
+{
+    if (vsync) {
+        *vsync = (window->internal && !window->internal->display->primary) ? 0 : vsync_interval;
+    }
+    return true;
+}
+
+bool SDL_ESPIDF_GetVSyncStats(SDL_Window *window, Uint64 *refreshes, Uint64 *missed)
+{
+    if (!ESPIDF_HasRefreshSource()) {
+        return SDL_Unsupported();
+    }
+    if (refreshes) {
+        *refreshes = refresh_count;
+    }
+    if (missed) {
+        *missed = missed_refreshes;
+    }
+    return true;
+}
+
+#endif /* SDL_VIDEO_DRIVER_PRIVATE */
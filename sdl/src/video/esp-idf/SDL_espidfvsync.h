@@ -0,0 +1,21 @@
+#ifndef SDL_espidfvsync_h_
+#define SDL_espidfvsync_h_
+
+#include "SDL_internal.h"
+
+extern bool SDL_ESPIDF_SetWindowFramebufferVSync(SDL_VideoDevice *_this, SDL_Window *window, int vsync);
+extern bool SDL_ESPIDF_GetWindowFramebufferVSync(SDL_VideoDevice *_this, SDL_Window *window, int *vsync);
+
+// RGB and DSI panels report refreshes through their callbacks, SPI/i80 panels through TE or a timer
+extern bool ESPIDF_HasRefreshSource(void);
+extern void ESPIDF_StartRefreshSource(void);
+extern void ESPIDF_StopRefreshSource(void);
+// Called from the panel ISR at the start of every refresh, returns whether a task was woken
+extern bool ESPIDF_NotifyRefreshFromISR(void);
+extern uint32_t ESPIDF_GetRefreshCount(void);
+// Block until the refresh counter reaches refresh, gives up if refreshes stop coming
+extern void ESPIDF_WaitForRefresh(uint32_t refresh);
+// Hold the present back until the vsync interval is due, latency is the refreshes until the frame shows
+extern void ESPIDF_PaceFrame(int latency);
+
+#endif /* SDL_espidfvsync_h_ */
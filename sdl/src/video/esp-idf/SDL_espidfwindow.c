@@ -0,0 +1,57 @@
+#include "SDL_internal.h"
+
+#ifdef SDL_VIDEO_DRIVER_PRIVATE
+
+#include "video/SDL_sysvideo.h"
+#include "SDL_espidfwindow.h"
+#include "SDL_espidfband.h"
+#include "SDL_espidfframebuffer.h"
+#include "SDL_espidfscale.h"
+#include "SDL3/SDL_esp-idf.h"
+#include "esp_heap_caps.h"
+
+bool ESPIDF_CreateWindow(SDL_VideoDevice *_this, SDL_Window *window, SDL_PropertiesID create_props)
+{
+    // Kept on the window, the framebuffer reads the surface placement when it is created
+    static const char *const surface_props[] = {
+        SDL_PROP_WINDOW_CREATE_ESPIDF_SURFACE_CAPS_NUMBER,
+        SDL_PROP_WINDOW_CREATE_ESPIDF_SURFACE_ALIGN_NUMBER,
+        SDL_PROP_WINDOW_CREATE_ESPIDF_SURFACE_PITCH_ALIGN_NUMBER,
+    };
+    SDL_PropertiesID props = SDL_GetWindowProperties(window);
+    SDL_VideoDisplay *display = SDL_GetVideoDisplayForWindow(window);
+    SDL_WindowData *data;
+
+    for (size_t i = 0; i < SDL_arraysize(surface_props); i++) {
+        if (SDL_HasProperty(create_props, surface_props[i])) {
+            SDL_SetNumberProperty(props, surface_props[i], SDL_GetNumberProperty(create_props, surface_props[i], 0));
+        }
+    }
+
+    // The panel ISRs use the window data, it must stay reachable while the flash cache is off
+    data = heap_caps_calloc(1, sizeof(*data), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!data) {
+        return SDL_OutOfMemory();
+    }
+
+    // Windows go to the panel they are positioned on, the BSP panel by default
+    data->display = (display && display->internal) ? display->internal : ESPIDF_GetPrimaryPanel();
+    data->lcd_ring_depth = 1;
+    data->max_chunk_height = CONFIG_SDL_ESPIDF_CHUNK_HEIGHT;
+    data->full_frame_percent = CONFIG_SDL_ESPIDF_DIRTY_RECT_FULL_FRAME_PERCENT;
+    data->format = SDL_PIXELFORMAT_RGB565;
+    data->surface_align = ESPIDF_SURFACE_ALIGN;
+    ESPIDF_InitPresentation(data);
+    window->internal = data;
+    return true;
+}
+
+void ESPIDF_DestroyWindow(SDL_VideoDevice *_this, SDL_Window *window)
+{
+    // SDL destroys the window framebuffer first, the bands are the only flush left
+    ESPIDF_DestroyBands(window);
+    heap_caps_free(window->internal);
+    window->internal = NULL;
+}
+
+#endif /* SDL_VIDEO_DRIVER_PRIVATE */
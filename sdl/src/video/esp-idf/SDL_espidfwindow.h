@@ -0,0 +1,105 @@
+#ifndef SDL_espidfwindow_h_
+#define SDL_espidfwindow_h_
+
+#include "SDL_internal.h"
+#include "video/SDL_sysvideo.h"
+#include "SDL_espidfshared.h"
+#include "SDL_espidfconvert.h"
+#include "SDL_espidfdiff.h"
+#include "SDL_espidfstats.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#ifdef CONFIG_IDF_TARGET_ESP32P4
+#include "driver/ppa.h"
+#endif
+
+// Values of SDL_HINT_ESPIDF_INTERLACE
+typedef enum {
+    ESPIDF_INTERLACE_OFF,
+    ESPIDF_INTERLACE_ON,
+    ESPIDF_INTERLACE_AUTO,  // Only while the window keeps sending full frames
+} ESPIDF_InterlaceMode;
+
+/*
+ * Driver state of one window, hung off SDL_Window->internal. The panel ISRs
+ * reach it through their user context, so it is kept in internal RAM.
+ */
+struct SDL_WindowData
+{
+    SDL_DisplayData *display;  // Panel the window is shown on
+    SDL_Surface *surface;      // Window framebuffer surface, NULL while there is none
+
+    // Counts free chunk slots, given back from the panel ISR when a chunk has been sent
+    SemaphoreHandle_t lcd_semaphore;
+    int lcd_ring_depth;  // Number of chunks that may be in flight at once
+    int max_chunk_height;
+    int full_frame_percent;
+    SDL_PixelFormat format;
+
+    // Panel position of the window surface, from the window position and kept on the panel
+    int x, y;
+    bool moved;  // Placement changed since the last present, the whole surface goes out again
+
+    // Interlaced flush of SPI/i80 panels, see SDL_HINT_ESPIDF_INTERLACE
+    ESPIDF_InterlaceMode interlace;  // Kept current by a hint callback
+    int field;               // Row parity sent by the last interlaced present
+    int motion_frames;       // Presents in a row that sent the whole frame
+    SDL_Rect field_pending;  // Area whose other field is not on the panel yet
+
+    // Window surface placement, picked when the framebuffer is created
+    uint32_t surface_caps;
+    size_t surface_align;
+    int surface_pitch_align;  // 0 for the default of the build configuration
+    uint8_t *surface_pixels;  // Synchronous window surface pixels, freed with the framebuffer
+    const void *placed_pixels;  // First window surface allocation, reported by esp_idf_log_free_dma
+    size_t placed_size;
+    int placed_pitch;
+
+    ESPIDF_TileDiff diff;
+
+    // Presentation on the rotated display, see SDL_espidfscale.c, only ever scaled on the primary panel
+    int present_w, present_h;  // Surface size it was worked out for
+    SDL_RendererLogicalPresentation present_mode;
+    int scale_x16, scale_y16;  // Display pixels per surface pixel, in 1/16 steps
+    SDL_Rect present_rect;     // Area of the rotated display the surface covers
+
+    // Dynamic resolution, see SDL_HINT_ESPIDF_FRAME_BUDGET_US
+    int render_div16;  // Logical size over render size, in 1/16 steps
+    int64_t budget_present_end;  // When the last present returned, 0 before the first one
+    int64_t budget_sum;
+    int budget_frames;
+
+    // Band mode, see SDL_ESPIDF_RenderBands: the surface holds a band of rows drawn by band_renderer
+    SDL_Renderer *band_renderer;
+    int band_y;  // Window row the band starts at while it is flushed
+    int band_h;  // Window height the bands were set up for
+
+    Uint64 submitted_frame;  // Last frame handed over by SDL_UpdateWindowSurface
+    Uint64 completed_frame;  // Last frame whose chunks have all been sent
+
+#ifdef CONFIG_SDL_ESPIDF_PRESENT_STATS
+    ESPIDF_PresentStats stats;
+#endif
+
+#ifdef CONFIG_IDF_TARGET_ESP32P4
+    ppa_client_handle_t ppa_srm_handle;
+    // Ring of PPA output buffers, the PPA scales chunk k+1 while chunk k is copied to the panel
+    uint8_t *ppa_out_ring[CONFIG_SDL_ESPIDF_DMA_RING_DEPTH];
+    int ppa_ring_next;
+    size_t ppa_out_buf_size;  // Size of each PPA output buffer
+    SemaphoreHandle_t ppa_done_semaphore;  // Given from the PPA ISR per finished transaction
+#else
+    // Ring of DMA-capable chunk buffers in the panel format, chunk k+1 is converted while chunk k is on the bus
+    uint8_t *chunk_ring[CONFIG_SDL_ESPIDF_DMA_RING_DEPTH];
+    int chunk_ring_next;
+    ESPIDF_ConvertFunc convert_rgb565;  // Byte swap kernel picked by ESPIDF_SelectConvertKernel
+    ESPIDF_Convert24Func convert_24;    // Set for 18/24-bit panels, replaces the byte swap
+    ESPIDF_ExpandFunc expand_pixels;    // Set for reduced-depth window surfaces
+    ESPIDF_ExpandLUT expand_lut;
+#endif
+};
+
+extern bool ESPIDF_CreateWindow(SDL_VideoDevice *_this, SDL_Window *window, SDL_PropertiesID create_props);
+extern void ESPIDF_DestroyWindow(SDL_VideoDevice *_this, SDL_Window *window);
+
+#endif /* SDL_espidfwindow_h_ */